@@ -0,0 +1,594 @@
+#include "../include/Core.h"
+#include <cstdio>
+
+// ==================== CORE DATA STRUCTURE BENCHMARKS ====================
+// Times the public operations of the data/engine layer at increasing dataset
+// sizes. Each case runs `reps` times and reports the best and median ns/op.
+//
+// Usage: core_bench [--sizes 1000,10000] [--reps 3] [--filter text] [--json file]
+//   --sizes   comma separated dataset sizes (users, posts, notifications)
+//   --reps    repetitions per case
+//   --filter  only run cases whose name contains this text
+//   --json    also write the results as a JSON array to this file, one
+//             object per case: {"name", "n", "ops", "best_ns", "median_ns"}
+//
+// Read-only cases share one fixture per size; cases that mutate build a fresh
+// one for every repetition (setup is not timed).
+
+// ==================== RESULTS ====================
+struct BenchResult {
+    string name;
+    int n;
+    long long ops;
+    double bestNs;
+    double medianNs;
+};
+
+static vector<BenchResult> results;
+static string filterText;
+static int reps = 3;
+
+static double elapsedNs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+static void record(const string& name, int n, long long ops, vector<double>& perOp) {
+    sort(perOp.begin(), perOp.end());
+    BenchResult r = { name, n, ops, perOp[0], perOp[perOp.size() / 2] };
+    results.push_back(r);
+    printf("%-40s %9d %10lld %14.1f %14.1f\n", name.c_str(), n, ops, r.bestNs, r.medianNs);
+    fflush(stdout);
+}
+
+static bool selected(const string& name) {
+    return filterText.empty() || name.find(filterText) != string::npos;
+}
+
+// The databases log every save/load to cout; keep that out of the table
+class QuietCout {
+private:
+    streambuf* saved;
+    ostringstream sink;
+
+public:
+    QuietCout() { saved = cout.rdbuf(sink.rdbuf()); }
+    ~QuietCout() { cout.rdbuf(saved); }
+};
+
+// ==================== FIXTURE ====================
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static string userName(int i) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "user%07d", i);
+    return string(buffer);
+}
+
+static Timestamp minutesAgo(int minutes) {
+    Timestamp ts(2025, 1, 1, 0, 0, 0);
+    ts.day += minutes / (24 * 60) % 28;
+    ts.hour += minutes / 60 % 24;
+    ts.minute += minutes % 60;
+    return ts;
+}
+
+struct Fixture {
+    UserDatabase* users;
+    PostDatabase* posts;
+    NotificationQueue* notifications;
+    vector<User*> userList;
+    vector<int> postIDs;
+
+    Fixture() : users(new UserDatabase()), posts(new PostDatabase()), notifications(nullptr) {}
+    ~Fixture() {
+        delete notifications;
+        delete posts;
+        delete users;
+    }
+};
+
+// n users, each following up to 10 others, and n posts spread over them
+static Fixture* buildSocial(int n) {
+    Fixture* f = new Fixture();
+    for (int i = 0; i < n; i++) {
+        f->userList.push_back(f->users->registerUser(userName(i), "password123"));
+    }
+
+    uint32_t state = 88172645u;
+    int follows = min(10, n - 1);
+    for (int i = 0; i < n; i++) {
+        User* u = f->userList[i];
+        for (int k = 0; k < follows; k++) {
+            User* target = f->userList[nextRandom(state) % n];
+            if (target != u && u->addFollowing(target->userID)) target->addFollower(u->userID);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        User* author = f->userList[nextRandom(state) % n];
+        Post* p = f->posts->createPost(author->userID, author->username,
+                                       "Benchmark post body", minutesAgo(i));
+        f->postIDs.push_back(p->postID);
+    }
+    return f;
+}
+
+// ==================== CASES ====================
+static void benchRegisterUser(int n) {
+    if (!selected("UserDatabase::registerUser")) return;
+    vector<double> perOp;
+    for (int r = 0; r < reps; r++) {
+        UserDatabase* db = new UserDatabase();
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) db->registerUser(userName(i), "password123");
+        perOp.push_back(elapsedNs(start) / n);
+        delete db;
+    }
+    record("UserDatabase::registerUser", n, n, perOp);
+}
+
+// Two follower lists of n IDs each, drawn from 6n accounts, and a short
+// list of n / 100 (a small account against a large one)
+static void benchIntersect(int n) {
+    uint32_t state = 1597334677u;
+    vector<int> a, b, small;
+    for (int id = 0; (int)a.size() < n; id++) if (nextRandom(state) % 6 == 0) a.push_back(id);
+    for (int id = 0; (int)b.size() < n; id++) if (nextRandom(state) % 6 == 0) b.push_back(id);
+    for (int id = 0; (int)small.size() < max(n / 100, 1); id++) if (nextRandom(state) % 600 == 0) small.push_back(id);
+
+    volatile int sink = 0;
+    int calls = max(1, 1000000 / n);
+    struct Case { const char* name; const vector<int>* x; bool scalar; };
+    Case cases[] = {
+        { "intersectSorted (n x n)", &a, false },
+        { "intersectSortedScalar (n x n)", &a, true },
+        { "intersectSorted (n/100 x n)", &small, false },
+        { "intersectSortedScalar (n/100 x n)", &small, true },
+    };
+    for (const Case& c : cases) {
+        if (!selected(c.name)) continue;
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < calls; i++) {
+                const vector<int>& x = *c.x;
+                sink += c.scalar ? intersectSortedScalar(x.data(), (int)x.size(), b.data(), n, nullptr, 0)
+                                 : intersectSorted(x.data(), (int)x.size(), b.data(), n, nullptr, 0);
+            }
+            perOp.push_back(elapsedNs(start) / calls);
+        }
+        record(c.name, n, calls, perOp);
+    }
+}
+
+static void benchLookups(int n, Fixture* f) {
+    uint32_t state = 2463534242u;
+    vector<string> names;
+    vector<int> ids;
+    for (int i = 0; i < n; i++) {
+        User* u = f->userList[nextRandom(state) % n];
+        names.push_back(u->username);
+        ids.push_back(u->userID);
+    }
+
+    volatile int sink = 0;
+    if (selected("UserDatabase::login")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) sink += f->users->login(names[i], "password123") != nullptr;
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("UserDatabase::login", n, n, perOp);
+    }
+
+    if (selected("UserDatabase::searchByID")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) sink += f->users->searchByID(ids[i]) != nullptr;
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("UserDatabase::searchByID", n, n, perOp);
+    }
+
+    if (selected("UserDatabase::searchByUsername")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) sink += f->users->searchByUsername(names[i]) != nullptr;
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("UserDatabase::searchByUsername", n, n, perOp);
+    }
+
+    if (selected("UserDatabase::searchUsers")) {
+        // Middle digits of a username hit a handful of users; the prefix
+        // query matches everyone, so it measures the top-k cut-off
+        vector<string> queries;
+        for (int i = 0; i < n; i++) queries.push_back(names[i].substr(6, 4));
+        User* found[20];
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) sink += f->users->searchUsers(queries[i], found, 20);
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("UserDatabase::searchUsers", n, n, perOp);
+
+        perOp.clear();
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) sink += f->users->searchUsers("USER", found, 20, true);
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("UserDatabase::searchUsers (prefix)", n, n, perOp);
+    }
+
+    if (selected("User::isFollowing")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) {
+                sink += f->userList[i]->isFollowing(ids[i]);
+            }
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("User::isFollowing", n, n, perOp);
+    }
+
+    if (selected("PostDatabase::findPost")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) {
+                sink += f->posts->findPost(f->postIDs[nextRandom(state) % n]) != nullptr;
+            }
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("PostDatabase::findPost", n, n, perOp);
+    }
+
+    if (selected("Feed::generateFeed")) {
+        int calls = min(n, 1000);
+        Feed feed;
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < calls; i++) {
+                feed.generateFeed(f->userList[i], f->posts);
+                sink += feed.getCount();
+            }
+            perOp.push_back(elapsedNs(start) / calls);
+        }
+        record("Feed::generateFeed", n, calls, perOp);
+    }
+
+    if (selected("Feed::generateFeed (ranked)")) {
+        int calls = min(n, 1000);
+        Feed feed;
+        feed.setRanked(true);
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < calls; i++) {
+                feed.generateFeed(f->userList[i], f->posts);
+                sink += feed.getCount();
+            }
+            perOp.push_back(elapsedNs(start) / calls);
+        }
+        record("Feed::generateFeed (ranked)", n, calls, perOp);
+    }
+}
+
+static void benchPosts(int n, Fixture* f) {
+    User* author = f->userList[0];
+    volatile int sink = 0;
+
+    if (selected("PostDatabase::createPost")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            PostDatabase* db = new PostDatabase();
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) {
+                db->createPost(author->userID, author->username, "Benchmark post body", minutesAgo(i));
+            }
+            perOp.push_back(elapsedNs(start) / n);
+            delete db;
+        }
+        record("PostDatabase::createPost", n, n, perOp);
+    }
+
+    if (selected("PostDatabase::deletePost")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            PostDatabase* db = new PostDatabase();
+            vector<int> ids;
+            for (int i = 0; i < n; i++) {
+                ids.push_back(db->createPost(author->userID, author->username,
+                                             "Benchmark post body", minutesAgo(i))->postID);
+            }
+            // Delete in a shuffled order so lookups hit the whole list
+            uint32_t state = 362436069u;
+            for (int i = n - 1; i > 0; i--) swap(ids[i], ids[nextRandom(state) % (i + 1)]);
+
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) db->deletePost(ids[i]);
+            perOp.push_back(elapsedNs(start) / n);
+            delete db;
+        }
+        record("PostDatabase::deletePost", n, n, perOp);
+    }
+
+    if (selected("Post::addComment")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            Post* post = new Post(1, author->userID, author->username, "Benchmark post body",
+                                  minutesAgo(0));
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) {
+                post->addComment(author->userID, author->username, "Nice post!", minutesAgo(i));
+            }
+            perOp.push_back(elapsedNs(start) / n);
+            delete post;
+        }
+        record("Post::addComment", n, n, perOp);
+    }
+
+    if (selected("PostDatabase::searchPosts")) {
+        // Bodies of eight words from a 2000-word vocabulary, so a word is in
+        // about 0.4% of posts; the queries are a single word, an AND of two
+        // and a two-word phrase
+        PostDatabase* db = new PostDatabase();
+        uint32_t state = 521288629u;
+        for (int i = 0; i < n; i++) {
+            string body;
+            for (int w = 0; w < 8; w++) {
+                body += "w" + to_string(nextRandom(state) % 2000) + " ";
+            }
+            db->createPost(author->userID, author->username, body, minutesAgo(i));
+        }
+        const char* shapes[] = { "w%d", "w%d w%d", "\"w%d w%d\"" };
+        vector<string> queries;
+        for (int i = 0; i < n; i++) {
+            char query[64];
+            snprintf(query, sizeof(query), shapes[i % 3], (int)(nextRandom(state) % 2000),
+                     (int)(nextRandom(state) % 2000));
+            queries.push_back(query);
+        }
+        Post* found[20];
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) sink += db->searchPosts(queries[i], found, 20);
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("PostDatabase::searchPosts", n, n, perOp);
+        delete db;
+    }
+}
+
+static void benchNotifications(int n, Fixture* f) {
+    // Recipients cycle over the first 100 users so inboxes grow with n
+    int recipients = min(n, 100);
+
+    if (selected("NotificationQueue::addNotification")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            NotificationQueue* queue = new NotificationQueue(n);
+            uint32_t state = 521288629u;
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < n; i++) {
+                User* to = f->userList[i % recipients];
+                queue->addNotification(to->userID, (NotificationType)(1 + nextRandom(state) % 3),
+                                       1, "user0000000", 0, "liked your post", minutesAgo(i));
+            }
+            perOp.push_back(elapsedNs(start) / n);
+            delete queue;
+        }
+        record("NotificationQueue::addNotification", n, n, perOp);
+    }
+
+    if (selected("NotificationQueue::getAllNotifications")) {
+        // One inbox holding all n notifications
+        NotificationQueue* queue = new NotificationQueue(n);
+        int to = f->userList[0]->userID;
+        uint32_t state = 521288629u;
+        for (int i = 0; i < n; i++) {
+            queue->addNotification(to, (NotificationType)(1 + nextRandom(state) % 3),
+                                   1, "user0000000", 0, "liked your post", minutesAgo(i));
+        }
+
+        Notification** out = new Notification*[n];
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            int count = 0;
+            auto start = chrono::steady_clock::now();
+            queue->getAllNotifications(to, out, count, n);
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("NotificationQueue::getAllNotifications", n, n, perOp);
+        delete[] out;
+        delete queue;
+    }
+}
+
+static void benchPersistence(int n, Fixture* f) {
+    const string usersFile = "core_bench_users.tmp";
+    const string connectionsFile = "core_bench_connections.tmp";
+    const string postsFile = "core_bench_posts.tmp";
+    const string segmentFile = "core_bench_notifications.tmp";
+
+    if (selected("UserDatabase::saveToFile")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            QuietCout quiet;
+            auto start = chrono::steady_clock::now();
+            f->users->saveToFile(usersFile);
+            f->users->saveConnectionsToFile(connectionsFile);
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("UserDatabase::saveToFile", n, n, perOp);
+    }
+
+    if (selected("UserDatabase::loadFromFile")) {
+        {
+            QuietCout quiet;
+            f->users->saveToFile(usersFile);
+            f->users->saveConnectionsToFile(connectionsFile);
+        }
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            UserDatabase* db = new UserDatabase();
+            QuietCout quiet;
+            auto start = chrono::steady_clock::now();
+            db->loadFromFile(usersFile);
+            db->loadConnectionsFromFile(connectionsFile);
+            perOp.push_back(elapsedNs(start) / n);
+            delete db;
+        }
+        record("UserDatabase::loadFromFile", n, n, perOp);
+    }
+
+    if (selected("PostDatabase::saveToFile")) {
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            QuietCout quiet;
+            auto start = chrono::steady_clock::now();
+            f->posts->saveToFile(postsFile);
+            perOp.push_back(elapsedNs(start) / n);
+        }
+        record("PostDatabase::saveToFile", n, n, perOp);
+    }
+
+    if (selected("PostDatabase::loadFromFile")) {
+        {
+            QuietCout quiet;
+            f->posts->saveToFile(postsFile);
+        }
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            PostDatabase* db = new PostDatabase();
+            QuietCout quiet;
+            auto start = chrono::steady_clock::now();
+            db->loadFromFile(postsFile);
+            perOp.push_back(elapsedNs(start) / n);
+            delete db;
+        }
+        record("PostDatabase::loadFromFile", n, n, perOp);
+    }
+
+    if (selected("NotificationQueue::openSegment")) {
+        // Append n records through the segment, then time reopening it and
+        // replaying one inbox that holds all of them
+        remove(segmentFile.c_str());
+        int to = f->userList[0]->userID;
+        {
+            QuietCout quiet;
+            NotificationQueue* queue = new NotificationQueue(n);
+            queue->openSegment(segmentFile);
+            for (int i = 0; i < n; i++) {
+                queue->addNotification(to, LIKE, 1, "user0000000", 0, "liked your post",
+                                       minutesAgo(i));
+            }
+            delete queue;
+        }
+
+        Notification** out = new Notification*[n];
+        vector<double> perOp;
+        for (int r = 0; r < reps; r++) {
+            NotificationQueue* queue = new NotificationQueue(n);
+            QuietCout quiet;
+            int count = 0;
+            auto start = chrono::steady_clock::now();
+            queue->openSegment(segmentFile);
+            queue->getAllNotifications(to, out, count, n);
+            perOp.push_back(elapsedNs(start) / n);
+            delete queue;
+        }
+        record("NotificationQueue::openSegment", n, n, perOp);
+        delete[] out;
+    }
+
+    remove(usersFile.c_str());
+    remove(connectionsFile.c_str());
+    remove(postsFile.c_str());
+    remove(segmentFile.c_str());
+}
+
+// ==================== OUTPUT ====================
+static bool writeJson(const string& filename) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << filename << " for writing" << endl;
+        return false;
+    }
+
+    file << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer),
+                 "  {\"name\": \"%s\", \"n\": %d, \"ops\": %lld, \"best_ns\": %.1f, \"median_ns\": %.1f}%s\n",
+                 r.name.c_str(), r.n, r.ops, r.bestNs, r.medianNs,
+                 i + 1 < results.size() ? "," : "");
+        file << buffer;
+    }
+    file << "]\n";
+    return true;
+}
+
+int main(int argc, char** argv) {
+    vector<int> sizes;
+    string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Error: Missing value for " << arg << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--sizes") {
+            stringstream list(value);
+            string item;
+            while (getline(list, item, ',')) {
+                if (atoi(item.c_str()) > 1) sizes.push_back(atoi(item.c_str()));
+            }
+        } else if (arg == "--reps") {
+            reps = max(1, atoi(value.c_str()));
+        } else if (arg == "--filter") {
+            filterText = value;
+        } else if (arg == "--json") {
+            jsonPath = value;
+        } else {
+            cerr << "Error: Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes.push_back(1000);
+        sizes.push_back(10000);
+    }
+
+    printf("%-40s %9s %10s %14s %14s\n", "case", "n", "ops", "best ns/op", "median ns/op");
+    for (int n : sizes) {
+        benchRegisterUser(n);
+        benchIntersect(n);
+
+        Fixture* f = buildSocial(n);
+        benchLookups(n, f);
+        benchPosts(n, f);
+        benchNotifications(n, f);
+        benchPersistence(n, f);
+        delete f;
+    }
+
+    if (!jsonPath.empty() && !writeJson(jsonPath)) return 1;
+    return 0;
+}
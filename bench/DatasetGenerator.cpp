@@ -0,0 +1,407 @@
+#include "../include/Core.h"
+#include <cmath>
+#include <filesystem>
+
+// ==================== SYNTHETIC DATASET GENERATOR ====================
+// Writes a seeded, reproducible dataset straight into the files the app and
+// the benchmarks load: users.txt, connections.txt, posts.txt and (unless
+// disabled) notifications.dat.
+//
+//   followers  - each user follows a Pareto-distributed number of accounts,
+//                picked from a Zipf popularity ranking, so a few users end up
+//                with a large share of all followers
+//   posts      - authors skew toward popular users; times follow a daily
+//                activity curve over the last `days` days
+//   engagement - likes scale with the author's audience, comment threads
+//                have a heavy tail and replies arrive minutes to hours later
+//   inbox      - comments from the final week become COMMENT notifications
+//
+// Usage: dataset_gen [--users 100000] [--seed 42] [--out .]
+//                    [--avg-following 20] [--zipf 1.0] [--posts-per-user 5]
+//                    [--days 90] [--end 2025-06-30] [--no-notifications]
+
+// ==================== OPTIONS ====================
+struct GeneratorOptions {
+    int users = 100000;
+    uint64_t seed = 42;
+    string outDir = ".";
+    double avgFollowing = 20.0;
+    double zipf = 1.0;
+    double postsPerUser = 5.0;
+    int days = 90;
+    int endYear = 2025, endMonth = 6, endDay = 30;
+    bool notifications = true;
+};
+
+static const int FIRST_USER_ID = 1001;
+static const int FIRST_POST_ID = 1001;
+static const int MAX_FOLLOWING = 5000;
+static const int MAX_COMMENTS = 200;
+static const int NOTIFICATION_WINDOW_DAYS = 7;
+
+// ==================== RANDOM ====================
+// xorshift64*: small, fast and identical on every platform for a given seed
+class Random {
+private:
+    uint64_t state;
+
+public:
+    Random(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ull;
+    }
+
+    // Uniform in (0, 1]
+    double uniform() { return ((next() >> 11) + 1) * (1.0 / 9007199254740992.0); }
+    int below(int n) { return (int)(next() % (uint64_t)n); }
+
+    // Pareto with scale xm and shape alpha (mean xm*alpha/(alpha-1))
+    double pareto(double xm, double alpha) { return xm / pow(uniform(), 1.0 / alpha); }
+    double exponential(double mean) { return -mean * log(uniform()); }
+};
+
+// Samples ranks 0..n-1 with P(rank r) proportional to 1/(r+1)^s
+class ZipfSampler {
+private:
+    vector<double> cdf;
+
+public:
+    ZipfSampler(int n, double s) : cdf(n) {
+        double sum = 0;
+        for (int r = 0; r < n; r++) {
+            sum += 1.0 / pow(r + 1, s);
+            cdf[r] = sum;
+        }
+        for (int r = 0; r < n; r++) cdf[r] /= sum;
+    }
+
+    int sample(Random& rng) {
+        double u = rng.uniform();
+        int r = (int)(lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        return min(r, (int)cdf.size() - 1);
+    }
+};
+
+// ==================== TIME ====================
+// Seconds are counted from the start of the generated window; days are
+// converted to civil dates without the C library so output is independent
+// of the local time zone.
+static long long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(long long z, int& y, int& m, int& d) {
+    z += 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    long long doe = z - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    y = (int)(yoe + era * 400 + (m <= 2));
+}
+
+struct TimeWindow {
+    long long firstDay;     // Days since 1970-01-01 of the window start
+    long long seconds;      // Window length
+
+    Timestamp at(long long offset) const {
+        Timestamp ts;
+        long long day = firstDay + offset / 86400;
+        long long rest = offset % 86400;
+        civilFromDays(day, ts.year, ts.month, ts.day);
+        ts.hour = (int)(rest / 3600);
+        ts.minute = (int)(rest / 60 % 60);
+        ts.second = (int)(rest % 60);
+        return ts;
+    }
+};
+
+static void writeTimestamp(ostream& out, const Timestamp& ts) {
+    out << ts.year << " " << ts.month << " " << ts.day << " "
+        << ts.hour << " " << ts.minute << " " << ts.second << "\n";
+}
+
+// Relative activity per hour of day: quiet overnight, peaks at lunch and evening
+static const double HOURLY_ACTIVITY[24] = {
+    0.6, 0.4, 0.25, 0.15, 0.1, 0.15, 0.3, 0.6, 0.9, 1.0, 1.0, 1.1,
+    1.3, 1.2, 1.0, 1.0, 1.1, 1.3, 1.5, 1.7, 1.8, 1.6, 1.2, 0.9
+};
+
+static long long samplePostTime(Random& rng, const TimeWindow& window, double* hourCdf) {
+    long long day = rng.below((int)(window.seconds / 86400));
+    double u = rng.uniform();
+    int hour = 0;
+    while (hour < 23 && hourCdf[hour] < u) hour++;
+    return day * 86400 + hour * 3600 + rng.below(3600);
+}
+
+// ==================== CONTENT ====================
+static const char* HANDLES[] = {
+    "alex", "sam", "jordan", "taylor", "casey", "riley", "morgan", "jamie",
+    "quinn", "avery", "kai", "noor", "leo", "mia", "omar", "zara",
+    "ivy", "theo", "luca", "ana", "ravi", "sofia", "eli", "hana"
+};
+static const int HANDLE_COUNT = sizeof(HANDLES) / sizeof(HANDLES[0]);
+
+static const char* BIOS[] = {
+    "", "Love coding and coffee!", "Gaming enthusiast", "Traveling the world",
+    "Photography lover", "Music is life", "Runner. Reader. Cook.",
+    "Building things on the internet", "Dog person", "Opinions are my own"
+};
+static const int BIO_COUNT = sizeof(BIOS) / sizeof(BIOS[0]);
+
+static const char* TOPICS[] = {
+    "coffee", "the new album", "my morning run", "this weekend", "the game last night",
+    "C++ templates", "a great book", "the sunset", "my cat", "remote work",
+    "the conference", "street food", "the mountains", "a side project", "rain"
+};
+static const int TOPIC_COUNT = sizeof(TOPICS) / sizeof(TOPICS[0]);
+
+static const char* OPENERS[] = {
+    "Can't stop thinking about", "Hot take on", "Finally tried", "Quick update on",
+    "Anyone else excited about", "Spent the whole day on", "Loving", "Not sure about"
+};
+static const int OPENER_COUNT = sizeof(OPENERS) / sizeof(OPENERS[0]);
+
+static const char* REPLIES[] = {
+    "So true!", "Love this", "Haha same", "Where was this?", "Totally agree",
+    "Interesting take", "Need to try this", "Great post!", "This made my day", "Hmm, not sure"
+};
+static const int REPLY_COUNT = sizeof(REPLIES) / sizeof(REPLIES[0]);
+
+static string userName(int index) {
+    return string(HANDLES[index % HANDLE_COUNT]) + "_" + to_string(index);
+}
+
+static string postText(Random& rng) {
+    string text = string(OPENERS[rng.below(OPENER_COUNT)]) + " " + TOPICS[rng.below(TOPIC_COUNT)];
+    if (rng.below(3) == 0) text += " and " + string(TOPICS[rng.below(TOPIC_COUNT)]);
+    return text + (rng.below(2) ? "!" : ".");
+}
+
+// ==================== GENERATOR ====================
+struct GeneratedPost {
+    long long time;
+    int author;
+};
+
+static bool parseArgs(int argc, char** argv, GeneratorOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--no-notifications") {
+            options.notifications = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Error: Missing value for " << arg << endl;
+            return false;
+        }
+        string value = argv[++i];
+        if (arg == "--users") options.users = atoi(value.c_str());
+        else if (arg == "--seed") options.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--out") options.outDir = value;
+        else if (arg == "--avg-following") options.avgFollowing = atof(value.c_str());
+        else if (arg == "--zipf") options.zipf = atof(value.c_str());
+        else if (arg == "--posts-per-user") options.postsPerUser = atof(value.c_str());
+        else if (arg == "--days") options.days = atoi(value.c_str());
+        else if (arg == "--end") {
+            if (sscanf(value.c_str(), "%d-%d-%d", &options.endYear, &options.endMonth, &options.endDay) != 3) {
+                cerr << "Error: --end expects YYYY-MM-DD" << endl;
+                return false;
+            }
+        } else {
+            cerr << "Error: Unknown option " << arg << endl;
+            return false;
+        }
+    }
+    if (options.users < 2 || options.days < 1 || options.avgFollowing < 1.0) {
+        cerr << "Error: Need at least 2 users, 1 day and 1 follow per user" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    if (!parseArgs(argc, argv, options)) return 1;
+
+    int n = options.users;
+    filesystem::create_directories(options.outDir);
+    string dir = options.outDir + "/";
+    Random rng(options.seed);
+
+    TimeWindow window;
+    window.firstDay = daysFromCivil(options.endYear, options.endMonth, options.endDay) - options.days + 1;
+    window.seconds = (long long)options.days * 86400;
+
+    // Popularity ranking: popularity[r] is the user index holding rank r
+    vector<int> popularity(n);
+    for (int i = 0; i < n; i++) popularity[i] = i;
+    for (int i = n - 1; i > 0; i--) swap(popularity[i], popularity[rng.below(i + 1)]);
+    ZipfSampler zipf(n, options.zipf);
+
+    // ---------- Connections ----------
+    // Written first so follower counts are known when users.txt is written
+    vector<int> followerCount(n, 0), followingCount(n, 0);
+    long long edges = 0;
+    {
+        ofstream file(dir + "connections.txt");
+        if (!file.is_open()) {
+            cerr << "Error: Could not open " << dir << "connections.txt for writing" << endl;
+            return 1;
+        }
+
+        // Pareto shape 2 has mean 2*xm, so xm = avg/2
+        double xm = options.avgFollowing / 2.0;
+        int maxFollowing = min(MAX_FOLLOWING, n - 1);
+        vector<int> targets;
+        for (int i = 0; i < n; i++) {
+            int want = (int)min((double)maxFollowing, rng.pareto(xm, 2.0));
+            targets.clear();
+            for (int k = 0; k < want; k++) {
+                int t = popularity[zipf.sample(rng)];
+                if (t != i) targets.push_back(t);
+            }
+            sort(targets.begin(), targets.end());
+            targets.erase(unique(targets.begin(), targets.end()), targets.end());
+
+            for (int t : targets) {
+                file << FIRST_USER_ID + i << " " << FIRST_USER_ID + t << "\n";
+                followerCount[t]++;
+            }
+            followingCount[i] = (int)targets.size();
+            edges += targets.size();
+        }
+    }
+    cout << "Wrote " << edges << " follow edges" << endl;
+
+    // ---------- Users ----------
+    {
+        ofstream file(dir + "users.txt");
+        if (!file.is_open()) {
+            cerr << "Error: Could not open " << dir << "users.txt for writing" << endl;
+            return 1;
+        }
+
+        file << n << "\n";
+        for (int i = 0; i < n; i++) {
+            file << FIRST_USER_ID + i << "\n"
+                 << userName(i) << "\n"
+                 << "password123\n"
+                 << BIOS[rng.below(BIO_COUNT)] << "\n"
+                 << followerCount[i] << "\n"
+                 << followingCount[i] << "\n";
+        }
+    }
+    cout << "Wrote " << n << " users (password123)" << endl;
+
+    // ---------- Posts ----------
+    double hourCdf[24];
+    double hourTotal = 0;
+    for (int h = 0; h < 24; h++) hourTotal += HOURLY_ACTIVITY[h];
+    double running = 0;
+    for (int h = 0; h < 24; h++) {
+        running += HOURLY_ACTIVITY[h] / hourTotal;
+        hourCdf[h] = running;
+    }
+
+    // Half the posts come from the popularity ranking, half uniformly
+    long long postCount = (long long)(n * options.postsPerUser);
+    vector<GeneratedPost> posts(postCount);
+    for (long long p = 0; p < postCount; p++) {
+        posts[p].time = samplePostTime(rng, window, hourCdf);
+        posts[p].author = rng.below(2) ? popularity[zipf.sample(rng)] : rng.below(n);
+    }
+
+    // The post list is kept newest first, with newer posts holding larger IDs
+    sort(posts.begin(), posts.end(), [](const GeneratedPost& a, const GeneratedPost& b) {
+        return a.time > b.time;
+    });
+
+    NotificationQueue* notifications = nullptr;
+    if (options.notifications) {
+        string segmentPath = dir + "notifications.dat";
+        filesystem::remove(segmentPath);
+        notifications = new NotificationQueue();
+        notifications->openSegment(segmentPath);
+    }
+    long long notificationStart = window.seconds - (long long)NOTIFICATION_WINDOW_DAYS * 86400;
+
+    long long commentTotal = 0, notificationTotal = 0;
+    {
+        ofstream file(dir + "posts.txt");
+        if (!file.is_open()) {
+            cerr << "Error: Could not open " << dir << "posts.txt for writing" << endl;
+            delete notifications;
+            return 1;
+        }
+
+        vector<long long> commentTimes;
+        file << postCount << "\n";
+        for (long long p = 0; p < postCount; p++) {
+            const GeneratedPost& post = posts[p];
+            int postID = (int)(FIRST_POST_ID + postCount - 1 - p);
+            int audience = followerCount[post.author];
+            string author = userName(post.author);
+
+            int likes = (int)(rng.pareto(1.0, 1.5) - 1.0 + audience * 0.1 * rng.uniform());
+            int comments = min(MAX_COMMENTS, (int)(rng.pareto(1.0, 1.6) - 1.0));
+
+            // Replies arrive after the post, mostly within a few hours
+            commentTimes.clear();
+            for (int c = 0; c < comments; c++) {
+                long long t = post.time + 60 + (long long)rng.exponential(2.0 * 3600);
+                if (t < window.seconds) commentTimes.push_back(t);
+            }
+            sort(commentTimes.begin(), commentTimes.end());
+
+            file << postID << "\n"
+                 << FIRST_USER_ID + post.author << "\n"
+                 << author << "\n"
+                 << postText(rng) << "\n";
+            writeTimestamp(file, window.at(post.time));
+            file << likes << "\n"
+                 << commentTimes.size() << "\n";
+
+            for (size_t c = 0; c < commentTimes.size(); c++) {
+                int commenter = rng.below(2) ? popularity[zipf.sample(rng)] : rng.below(n);
+                string commenterName = userName(commenter);
+                Timestamp ts = window.at(commentTimes[c]);
+
+                file << "COMMENT\n"
+                     << c << "\n"
+                     << FIRST_USER_ID + commenter << "\n"
+                     << commenterName << "\n"
+                     << REPLIES[rng.below(REPLY_COUNT)] << "\n";
+                writeTimestamp(file, ts);
+
+                if (notifications && commenter != post.author && commentTimes[c] >= notificationStart) {
+                    notifications->addNotification(FIRST_USER_ID + post.author, COMMENT,
+                                                   FIRST_USER_ID + commenter, commenterName,
+                                                   postID, commenterName + " commented on your post", ts);
+                    notificationTotal++;
+                }
+            }
+            file << "END_COMMENTS\n";
+            commentTotal += commentTimes.size();
+        }
+    }
+    delete notifications;
+
+    cout << "Wrote " << postCount << " posts with " << commentTotal << " comments" << endl;
+    if (options.notifications) {
+        cout << "Wrote " << notificationTotal << " notifications" << endl;
+    }
+    return 0;
+}
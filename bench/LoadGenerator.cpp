@@ -0,0 +1,597 @@
+#include "../include/Core.h"
+#include <cstdio>
+#include <thread>
+
+// ==================== IN-PROCESS LOAD GENERATOR ====================
+// Drives UserDatabase / PostDatabase / Feed / NotificationQueue from several
+// threads with a weighted mix of user actions, or replays a recorded
+// operation log, and reports throughput and latency percentiles per action.
+//
+// Usage: load_gen [--data DIR | --users 10000] [--threads 4]
+//                 [--duration 10 | --ops N] [--seed 1]
+//                 [--mix login=5,feed=35,post=10,like=25,comment=10,follow=5,notifications=10]
+//                 [--record FILE] [--replay FILE] [--json FILE]
+//   --data      load users.txt, connections.txt and posts.txt from DIR
+//               (for example a dataset_gen output); otherwise a synthetic
+//               network of --users users is built in memory
+//   --duration  seconds to run; --ops runs a fixed number of operations instead
+//   --mix       relative weights; actions left out get weight 0
+//   --record    write every executed operation to FILE
+//   --replay    execute the operations in FILE (as fast as possible) instead
+//               of generating them; each user's operations keep their order
+//   --json      also write the report to FILE
+//
+// The core is not thread-safe, so every action holds one global lock while it
+// touches the databases, as a multi-threaded front end would have to today.
+// Latency includes the time spent waiting for that lock; the "wait" column
+// shows how much of it was contention. Notifications go through the lock-free
+// ring (postNotification) outside the lock and a drain thread files them,
+// like the GUI and server loops do.
+
+// ==================== OPERATIONS ====================
+enum OpType {
+    OP_LOGIN,
+    OP_FEED,
+    OP_POST,
+    OP_LIKE,
+    OP_COMMENT,
+    OP_FOLLOW,
+    OP_NOTIFICATIONS,
+    OP_COUNT
+};
+
+static const char* OP_NAMES[OP_COUNT] = {
+    "login", "feed", "post", "like", "comment", "follow", "notifications"
+};
+
+struct Operation {
+    long long offsetUs;     // Start time relative to the run (recording only)
+    OpType type;
+    int userID;
+    int target;             // Post ID for like/comment, user ID for follow
+};
+
+static int opFromName(const string& name) {
+    for (int i = 0; i < OP_COUNT; i++) {
+        if (name == OP_NAMES[i]) return i;
+    }
+    return -1;
+}
+
+// xorshift64*, as in dataset_gen
+class Random {
+private:
+    uint64_t state;
+
+public:
+    Random(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ull;
+    }
+
+    uint32_t below(uint32_t n) { return (uint32_t)(next() % n); }
+};
+
+// ==================== SHARED STATE ====================
+struct World {
+    UserDatabase users;
+    PostDatabase posts;
+    NotificationQueue* notifications;
+    int notificationCapacity;
+    mutex lock;
+
+    int* userIDs;               // Snapshot of every user ID, for picking actors
+    int userCount;
+    int minPostID;
+    atomic<int> maxPostID;
+
+    World() : notifications(nullptr), notificationCapacity(0), userIDs(nullptr),
+              userCount(0), minPostID(1), maxPostID(0) {}
+    ~World() {
+        delete notifications;
+        delete[] userIDs;
+    }
+};
+
+// The databases log every save/load to cout; keep that out of the report
+class QuietCout {
+private:
+    streambuf* saved;
+    ostringstream sink;
+
+public:
+    QuietCout() { saved = cout.rdbuf(sink.rdbuf()); }
+    ~QuietCout() { cout.rdbuf(saved); }
+};
+
+static void buildSynthetic(World& world, int n, uint64_t seed) {
+    Random rng(seed * 31 + 7);
+    User** created = new User*[n];
+    char name[16];
+    for (int i = 0; i < n; i++) {
+        snprintf(name, sizeof(name), "lg%07d", i);
+        created[i] = world.users.registerUser(name, "password123");
+    }
+
+    // Each user follows ~20 others and has written a few posts
+    int follows = min(20, n - 1);
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < follows; k++) {
+            User* target = created[rng.below(n)];
+            if (target != created[i] && created[i]->addFollowing(target->userID)) {
+                target->addFollower(created[i]->userID);
+            }
+        }
+    }
+    for (int i = 0; i < n * 3; i++) {
+        User* author = created[rng.below(n)];
+        Timestamp ts(2025, 1 + i % 12, 1 + i % 28, i % 24, i % 60, 0);
+        world.posts.createPost(author->userID, author->username, "Synthetic post for load testing", ts);
+    }
+    delete[] created;
+}
+
+static void snapshotWorld(World& world) {
+    world.userCount = world.users.getUserCount();
+    User** all = new User*[world.userCount];
+    int count = 0;
+    world.users.getAllUsers(all, count);
+    world.userIDs = new int[count];
+    for (int i = 0; i < count; i++) world.userIDs[i] = all[i]->userID;
+    world.userCount = count;
+    delete[] all;
+
+    int minID = 0, maxID = 0;
+    for (Post* p = world.posts.getHead(); p; p = p->next) {
+        if (minID == 0 || p->postID < minID) minID = p->postID;
+        if (p->postID > maxID) maxID = p->postID;
+    }
+    world.minPostID = minID > 0 ? minID : 1;
+    world.maxPostID.store(maxID);
+}
+
+// ==================== WORKER ====================
+struct Worker {
+    int index;
+    Feed feed;
+    Notification** notificationBuffer;
+    vector<uint32_t> latencyNs[OP_COUNT];
+    uint64_t waitNs[OP_COUNT];
+    long long misses[OP_COUNT];     // Actor or target not found, or a no-op
+    vector<Operation> recorded;
+    vector<Operation> script;       // Replay mode
+    long long postCounter;
+
+    Worker() : index(0), notificationBuffer(nullptr), postCounter(0) {
+        memset(waitNs, 0, sizeof(waitNs));
+        memset(misses, 0, sizeof(misses));
+    }
+    ~Worker() { delete[] notificationBuffer; }
+};
+
+static Operation generateOperation(World& world, Random& rng, const int* weights, int totalWeight) {
+    Operation op;
+    op.offsetUs = 0;
+    int pick = (int)rng.below(totalWeight);
+    int type = 0;
+    while (pick >= weights[type]) pick -= weights[type++];
+    op.type = (OpType)type;
+    op.userID = world.userIDs[rng.below(world.userCount)];
+    op.target = 0;
+
+    if (op.type == OP_FOLLOW) {
+        op.target = world.userIDs[rng.below(world.userCount)];
+    } else if (op.type == OP_LIKE || op.type == OP_COMMENT) {
+        int maxID = world.maxPostID.load(memory_order_relaxed);
+        if (maxID >= world.minPostID) {
+            op.target = world.minPostID + (int)rng.below(maxID - world.minPostID + 1);
+        }
+    }
+    return op;
+}
+
+// Returns false when the action did not happen (missing user/post, own post)
+static bool execute(World& world, Worker& worker, const Operation& op) {
+    // Notification to hand to the ring once the lock is released
+    bool notify = false;
+    NotificationType notifyType = LIKE;
+    int notifyTo = 0, notifyPost = 0;
+    string fromName, message;
+    Timestamp now;
+
+    auto waitStart = chrono::steady_clock::now();
+    {
+        lock_guard<mutex> guard(world.lock);
+        worker.waitNs[op.type] += chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - waitStart).count();
+
+        User* user = world.users.searchByID(op.userID);
+        if (!user) return false;
+        now = getCurrentTimestamp(); // localtime() is not thread-safe
+
+        switch (op.type) {
+            case OP_LOGIN:
+                if (!world.users.login(user->username, user->password)) return false;
+                break;
+
+            case OP_FEED:
+                worker.feed.generateFeed(user, &world.posts);
+                break;
+
+            case OP_POST: {
+                char content[64];
+                snprintf(content, sizeof(content), "Load test post %lld from worker %d",
+                         ++worker.postCounter, worker.index);
+                Post* post = world.posts.createPost(user->userID, user->username, content, now);
+                if (!post) return false;
+                if (post->postID > world.maxPostID.load(memory_order_relaxed)) {
+                    world.maxPostID.store(post->postID, memory_order_relaxed);
+                }
+                break;
+            }
+
+            case OP_LIKE:
+            case OP_COMMENT: {
+                Post* post = world.posts.findPost(op.target);
+                if (!post) return false;
+                if (op.type == OP_LIKE) {
+                    if (post->userID == user->userID) return false;
+                    world.posts.addLike(post);
+                    notifyType = LIKE;
+                    message = user->username + " liked your post";
+                } else {
+                    world.posts.addComment(post, user->userID, user->username, "Nice post!", now);
+                    notifyType = COMMENT;
+                    message = user->username + " commented on your post";
+                }
+                notify = true;
+                notifyTo = post->userID;
+                notifyPost = post->postID;
+                break;
+            }
+
+            case OP_FOLLOW: {
+                User* target = world.users.searchByID(op.target);
+                if (!target || target == user) return false;
+                // Toggle, so follow counts stay stable over long runs
+                if (user->isFollowing(target->userID)) {
+                    user->removeFollowing(target->userID);
+                    target->removeFollower(user->userID);
+                } else {
+                    user->addFollowing(target->userID);
+                    target->addFollower(user->userID);
+                    notify = true;
+                    notifyType = FOLLOW;
+                    notifyTo = target->userID;
+                    message = user->username + " followed you";
+                }
+                break;
+            }
+
+            case OP_NOTIFICATIONS: {
+                int count = 0;
+                world.notifications->getAllNotifications(user->userID, worker.notificationBuffer, count,
+                                                         world.notificationCapacity);
+                if (count > 0) world.notifications->markAllRead(user->userID);
+                break;
+            }
+
+            default:
+                return false;
+        }
+        if (notify) fromName = user->username;
+    }
+
+    if (notify) {
+        // Drops under sustained overload show up as notification_ring_full
+        world.notifications->postNotification(notifyTo, notifyType, op.userID, fromName,
+                                              notifyPost, message, now);
+    }
+    return true;
+}
+
+static void runOperation(World& world, Worker& worker, const Operation& op, bool record,
+                         chrono::steady_clock::time_point runStart) {
+    auto start = chrono::steady_clock::now();
+    bool done = execute(world, worker, op);
+    uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+    worker.latencyNs[op.type].push_back((uint32_t)min<uint64_t>(ns, 0xFFFFFFFFu));
+    if (!done) worker.misses[op.type]++;
+    if (record) {
+        Operation logged = op;
+        logged.offsetUs = chrono::duration_cast<chrono::microseconds>(start - runStart).count();
+        worker.recorded.push_back(logged);
+    }
+}
+
+// ==================== OPERATION LOG ====================
+// One line per operation: <offsetUs> <op> <userID> <target>
+static bool writeLog(const string& filename, Worker* workers, int threads) {
+    vector<Operation> all;
+    for (int t = 0; t < threads; t++) {
+        all.insert(all.end(), workers[t].recorded.begin(), workers[t].recorded.end());
+    }
+    stable_sort(all.begin(), all.end(), [](const Operation& a, const Operation& b) {
+        return a.offsetUs < b.offsetUs;
+    });
+
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << filename << " for writing" << endl;
+        return false;
+    }
+    for (const Operation& op : all) {
+        file << op.offsetUs << " " << OP_NAMES[op.type] << " " << op.userID << " " << op.target << "\n";
+    }
+    cout << "Recorded " << all.size() << " operations to " << filename << endl;
+    return true;
+}
+
+// Splits the log across workers by user so each user's actions stay in order
+static bool readLog(const string& filename, Worker* workers, int threads) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << filename << endl;
+        return false;
+    }
+
+    string line, name;
+    long long total = 0;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty()) continue;
+        istringstream fields(line);
+        Operation op;
+        if (!(fields >> op.offsetUs >> name >> op.userID >> op.target) || opFromName(name) < 0) {
+            cerr << "Error: Bad operation on line " << lineNumber << " of " << filename << endl;
+            return false;
+        }
+        op.type = (OpType)opFromName(name);
+        workers[(unsigned)op.userID % threads].script.push_back(op);
+        total++;
+    }
+    cout << "Replaying " << total << " operations from " << filename << endl;
+    return true;
+}
+
+// ==================== REPORT ====================
+struct OpReport {
+    const char* name;
+    long long count;
+    long long misses;
+    double p50Us, p90Us, p99Us, p999Us, maxUs, waitUs;
+};
+
+static double percentileUs(const vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = (size_t)(p * sorted.size() + 0.999999); // Nearest rank
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1] / 1000.0;
+}
+
+static bool writeJson(const string& filename, const vector<OpReport>& reports, int threads,
+                      double seconds, long long totalOps) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << filename << " for writing" << endl;
+        return false;
+    }
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+             "{\"threads\": %d, \"seconds\": %.3f, \"ops\": %lld, \"ops_per_sec\": %.1f, \"actions\": [\n",
+             threads, seconds, totalOps, totalOps / seconds);
+    file << buffer;
+    for (size_t i = 0; i < reports.size(); i++) {
+        const OpReport& r = reports[i];
+        snprintf(buffer, sizeof(buffer),
+                 "{\"name\": \"%s\", \"count\": %lld, \"misses\": %lld, \"ops_per_sec\": %.1f, "
+                 "\"p50_us\": %.2f, \"p90_us\": %.2f, \"p99_us\": %.2f, \"p999_us\": %.2f, "
+                 "\"max_us\": %.2f, \"mean_wait_us\": %.2f}%s\n",
+                 r.name, r.count, r.misses, r.count / seconds, r.p50Us, r.p90Us, r.p99Us,
+                 r.p999Us, r.maxUs, r.waitUs, i + 1 < reports.size() ? "," : "");
+        file << buffer;
+    }
+    file << "]}\n";
+    cout << "Wrote report to " << filename << endl;
+    return true;
+}
+
+// ==================== MAIN ====================
+static bool parseMix(const string& text, int* weights) {
+    for (int i = 0; i < OP_COUNT; i++) weights[i] = 0;
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        size_t eq = item.find('=');
+        int op = eq == string::npos ? -1 : opFromName(item.substr(0, eq));
+        if (op < 0) {
+            cerr << "Error: Bad --mix entry '" << item << "'" << endl;
+            return false;
+        }
+        weights[op] = max(0, atoi(item.c_str() + eq + 1));
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    string dataDir, recordPath, replayPath, jsonPath;
+    int syntheticUsers = 10000;
+    int threads = 4;
+    double duration = 10;
+    long long opsLimit = 0;
+    uint64_t seed = 1;
+    int weights[OP_COUNT];
+    parseMix("login=5,feed=35,post=10,like=25,comment=10,follow=5,notifications=10", weights);
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Error: Missing value for " << arg << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--data") dataDir = value;
+        else if (arg == "--users") syntheticUsers = max(2, atoi(value.c_str()));
+        else if (arg == "--threads") threads = max(1, atoi(value.c_str()));
+        else if (arg == "--duration") duration = atof(value.c_str());
+        else if (arg == "--ops") opsLimit = atoll(value.c_str());
+        else if (arg == "--seed") seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--record") recordPath = value;
+        else if (arg == "--replay") replayPath = value;
+        else if (arg == "--json") jsonPath = value;
+        else if (arg == "--mix") {
+            if (!parseMix(value, weights)) return 1;
+        } else {
+            cerr << "Error: Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    int totalWeight = 0;
+    for (int i = 0; i < OP_COUNT; i++) totalWeight += weights[i];
+    if (totalWeight == 0 && replayPath.empty()) {
+        cerr << "Error: --mix gives every action weight 0" << endl;
+        return 1;
+    }
+
+    // ---------- Setup ----------
+    World world;
+    auto setupStart = chrono::steady_clock::now();
+    if (!dataDir.empty()) {
+        QuietCout quiet;
+        world.users.loadFromFile(dataDir + "/users.txt");
+        world.users.loadConnectionsFromFile(dataDir + "/connections.txt");
+        world.posts.loadFromFile(dataDir + "/posts.txt");
+    } else {
+        buildSynthetic(world, syntheticUsers, seed);
+    }
+    snapshotWorld(world);
+    if (world.userCount == 0) {
+        cerr << "Error: No users loaded" << endl;
+        return 1;
+    }
+
+    world.notificationCapacity = 1 << 18;
+    world.notifications = new NotificationQueue(world.notificationCapacity, 65536);
+    printf("Setup: %d users, posts %d..%d (%.1f s)\n", world.userCount, world.minPostID,
+           world.maxPostID.load(),
+           chrono::duration<double>(chrono::steady_clock::now() - setupStart).count());
+
+    Worker* workers = new Worker[threads];
+    for (int t = 0; t < threads; t++) {
+        workers[t].index = t;
+        workers[t].notificationBuffer = new Notification*[world.notificationCapacity];
+    }
+    if (!replayPath.empty() && !readLog(replayPath, workers, threads)) {
+        delete[] workers;
+        return 1;
+    }
+
+    // ---------- Run ----------
+    atomic<bool> go(false), stop(false);
+    atomic<long long> opsIssued(0);
+    bool record = !recordPath.empty();
+    bool replay = !replayPath.empty();
+    chrono::steady_clock::time_point runStart;
+
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            Worker& worker = workers[t];
+            Random rng(seed * 0x9E3779B97F4A7C15ull + t + 1);
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+
+            if (replay) {
+                for (const Operation& op : worker.script) {
+                    runOperation(world, worker, op, record, runStart);
+                }
+                return;
+            }
+            while (!stop.load(memory_order_relaxed)) {
+                if (opsLimit > 0 && opsIssued.fetch_add(1, memory_order_relaxed) >= opsLimit) break;
+                Operation op = generateOperation(world, rng, weights, totalWeight);
+                runOperation(world, worker, op, record, runStart);
+            }
+        });
+    }
+
+    // Consumer side of the notification ring
+    atomic<bool> workersDone(false);
+    thread drainer([&]() {
+        while (!workersDone.load(memory_order_acquire)) {
+            {
+                lock_guard<mutex> guard(world.lock);
+                world.notifications->drainPending();
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+
+    runStart = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    if (!replay && opsLimit == 0) {
+        this_thread::sleep_for(chrono::duration<double>(duration));
+        stop.store(true);
+    }
+    for (thread& t : pool) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+    workersDone.store(true, memory_order_release);
+    drainer.join();
+    world.notifications->drainPending();
+
+    // ---------- Report ----------
+    vector<OpReport> reports;
+    long long totalOps = 0;
+    vector<uint32_t> merged;
+    for (int op = 0; op < OP_COUNT; op++) {
+        merged.clear();
+        uint64_t waitNs = 0;
+        long long misses = 0;
+        for (int t = 0; t < threads; t++) {
+            merged.insert(merged.end(), workers[t].latencyNs[op].begin(), workers[t].latencyNs[op].end());
+            waitNs += workers[t].waitNs[op];
+            misses += workers[t].misses[op];
+        }
+        if (merged.empty()) continue;
+        sort(merged.begin(), merged.end());
+
+        OpReport r;
+        r.name = OP_NAMES[op];
+        r.count = (long long)merged.size();
+        r.misses = misses;
+        r.p50Us = percentileUs(merged, 0.50);
+        r.p90Us = percentileUs(merged, 0.90);
+        r.p99Us = percentileUs(merged, 0.99);
+        r.p999Us = percentileUs(merged, 0.999);
+        r.maxUs = merged.back() / 1000.0;
+        r.waitUs = waitNs / 1000.0 / merged.size();
+        reports.push_back(r);
+        totalOps += r.count;
+    }
+
+    printf("\n%d threads, %.2f s, %lld ops, %.0f ops/s\n\n", threads, seconds, totalOps, totalOps / seconds);
+    printf("%-14s %10s %8s %10s %10s %10s %10s %10s %10s %10s\n", "action", "count", "misses",
+           "ops/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us", "wait us");
+    for (const OpReport& r : reports) {
+        printf("%-14s %10lld %8lld %10.0f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+               r.name, r.count, r.misses, r.count / seconds, r.p50Us, r.p90Us, r.p99Us,
+               r.p999Us, r.maxUs, r.waitUs);
+    }
+    printf("\nNotifications: %llu posted, %llu ring full, %llu evicted (inbox full)\n",
+           (unsigned long long)Metrics::notificationsPosted.get(),
+           (unsigned long long)Metrics::notificationRingFull.get(),
+           (unsigned long long)Metrics::notificationsEvicted.get());
+
+    bool ok = true;
+    if (record) ok = writeLog(recordPath, workers, threads) && ok;
+    if (!jsonPath.empty()) ok = writeJson(jsonPath, reports, threads, seconds, totalOps) && ok;
+    delete[] workers;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include "../include/Core.h"
+#include <thread>
+#include <mutex>
+
+// ==================== NOTIFICATION INGESTION BENCHMARK ====================
+// Measures end-to-end throughput of producer threads handing notifications to
+// a single consumer that files them into per-user inboxes.
+//
+//   ring  - producers call postNotification() (lock-free MPSC ring), the
+//           consumer thread loops on drainPending()
+//   mutex - producers take a shared std::mutex and call addNotification()
+//
+// Usage: notification_ingest_bench [maxProducers] [perProducer]
+//   Runs 1, 2, 4, ... up to maxProducers (default 16) producer threads, each
+//   sending perProducer (default 250000) notifications.
+
+static const int RECIPIENTS = 10000;
+
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static double runRing(int producers, int perProducer) {
+    int total = producers * perProducer;
+    NotificationQueue* queue = new NotificationQueue(total, 65536);
+    atomic<bool> go(false);
+
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+            Timestamp ts;
+            for (int i = 0; i < perProducer; i++) {
+                ts.second = i % 60;
+                while (!queue->postNotification(1001 + (p * perProducer + i) % RECIPIENTS, LIKE,
+                                                p, "", 0, "", ts)) {
+                    this_thread::yield(); // Ring full; let the consumer catch up
+                }
+            }
+        });
+    }
+
+    auto start = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    int drained = 0;
+    while (drained < total) {
+        int n = queue->drainPending();
+        if (n == 0) this_thread::yield();
+        drained += n;
+    }
+    double ms = elapsedMs(start);
+
+    for (auto& t : threads) t.join();
+    delete queue;
+    return ms;
+}
+
+static double runMutex(int producers, int perProducer) {
+    int total = producers * perProducer;
+    NotificationQueue* queue = new NotificationQueue(total);
+    mutex lock;
+    atomic<bool> go(false);
+
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+            Timestamp ts;
+            for (int i = 0; i < perProducer; i++) {
+                ts.second = i % 60;
+                lock_guard<mutex> guard(lock);
+                queue->addNotification(1001 + (p * perProducer + i) % RECIPIENTS, LIKE,
+                                       p, "", 0, "", ts);
+            }
+        });
+    }
+
+    auto start = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    for (auto& t : threads) t.join();
+    double ms = elapsedMs(start);
+
+    delete queue;
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    int maxProducers = argc > 1 ? atoi(argv[1]) : 16;
+    int perProducer = argc > 2 ? atoi(argv[2]) : 250000;
+
+    printf("hardware threads: %u\n", thread::hardware_concurrency());
+    printf("%-6s %9s %12s %12s\n", "mode", "producers", "ms", "Mnotif/s");
+
+    for (int producers = 1; producers <= maxProducers; producers *= 2) {
+        double total = (double)producers * perProducer;
+        double ringMs = runRing(producers, perProducer);
+        printf("%-6s %9d %12.2f %12.2f\n", "ring", producers, ringMs, total / ringMs / 1000.0);
+        double mutexMs = runMutex(producers, perProducer);
+        printf("%-6s %9d %12.2f %12.2f\n", "mutex", producers, mutexMs, total / mutexMs / 1000.0);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "../include/Core.h"
+
+// ==================== NOTIFICATION QUEUE MICROBENCHMARK ====================
+// Compares the slab/4-ary NotificationQueue against the original
+// pointer-based recursive binary heap at increasing queue sizes.
+//
+// Usage: notification_bench [maxEntries] [legacy|4-ary]
+//   maxEntries defaults to 10000000; sizes run from 10k up in steps of 10x.
+//   Passing one implementation name runs only that one, which keeps the
+//   allocator state of one run from skewing the other's insert timings.
+
+// ==================== LEGACY QUEUE (ORIGINAL IMPLEMENTATION) ====================
+class LegacyNotificationQueue {
+private:
+    Notification** heap;
+    int capacity;
+    int size;
+    int nextID;
+
+    int parent(int i) { return (i - 1) / 2; }
+    int leftChild(int i) { return 2 * i + 1; }
+    int rightChild(int i) { return 2 * i + 2; }
+
+    void swap(int i, int j) {
+        Notification* temp = heap[i];
+        heap[i] = heap[j];
+        heap[j] = temp;
+    }
+
+    void heapifyUp(int index) {
+        while (index > 0 && heap[index]->hasHigherPriority(*heap[parent(index)])) {
+            swap(index, parent(index));
+            index = parent(index);
+        }
+    }
+
+    void heapifyDown(int index) {
+        int smallest = index;
+        int left = leftChild(index);
+        int right = rightChild(index);
+        if (left < size && heap[left]->hasHigherPriority(*heap[smallest])) smallest = left;
+        if (right < size && heap[right]->hasHigherPriority(*heap[smallest])) smallest = right;
+        if (smallest != index) {
+            swap(index, smallest);
+            heapifyDown(smallest);
+        }
+    }
+
+public:
+    LegacyNotificationQueue(int cap) : capacity(cap), size(0), nextID(1) {
+        heap = new Notification*[capacity];
+    }
+
+    ~LegacyNotificationQueue() {
+        for (int i = 0; i < size; i++) delete heap[i];
+        delete[] heap;
+    }
+
+    void addNotification(int toUserID, NotificationType type, int fromUserID,
+                         const string& fromUsername, int postID, const string& message,
+                         Timestamp timestamp) {
+        if (size >= capacity) return;
+        heap[size] = new Notification(nextID++, type, toUserID, fromUserID,
+                                      fromUsername, postID, message, timestamp);
+        heapifyUp(size);
+        size++;
+    }
+
+    void getAllNotifications(int, Notification** arr, int& count, int) {
+        count = size;
+        Notification** temp = new Notification*[size];
+        int tempSize = size;
+        for (int i = 0; i < tempSize; i++) {
+            temp[i] = heap[0];
+            heap[0] = heap[size - 1];
+            size--;
+            heapifyDown(0);
+        }
+        for (int i = 0; i < tempSize; i++) arr[i] = temp[i];
+        for (int i = 0; i < tempSize; i++) {
+            heap[size] = temp[i];
+            heapifyUp(size);
+            size++;
+        }
+        delete[] temp;
+    }
+};
+
+// ==================== HARNESS ====================
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Deterministic pseudo-random timestamps and types (xorshift)
+static Timestamp makeTimestamp(uint32_t& state, NotificationType& type) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    type = (NotificationType)(1 + state % 3);
+    return Timestamp(2025, 1 + (state >> 2) % 12, 1 + (state >> 6) % 28,
+                     (state >> 11) % 24, (state >> 16) % 60, (state >> 22) % 60);
+}
+
+template <typename Queue>
+static void runCase(const char* name, int n, Notification** out) {
+    uint32_t state = 2463534242u;
+    NotificationType type;
+
+    auto start = chrono::steady_clock::now();
+    Queue* queue = new Queue(n);
+    for (int i = 0; i < n; i++) {
+        Timestamp ts = makeTimestamp(state, type);
+        queue->addNotification(1001, type, 1, "", 0, "", ts);
+    }
+    double addMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    int count = 0;
+    queue->getAllNotifications(1001, out, count, n);
+    double drainMs = elapsedMs(start);
+
+    // Sanity check: output must be in priority order
+    for (int i = 1; i < count; i++) {
+        if (out[i]->hasHigherPriority(*out[i - 1])) {
+            cerr << name << ": order violated at " << i << endl;
+            break;
+        }
+    }
+
+    printf("%-8s %10d  add %10.2f ms (%6.1f ns/op)  getAll %10.2f ms (%6.1f ns/op)\n",
+           name, n, addMs, addMs * 1e6 / n, drainMs, drainMs * 1e6 / n);
+    delete queue;
+}
+
+int main(int argc, char** argv) {
+    int maxEntries = argc > 1 ? atoi(argv[1]) : 10000000;
+    string only = argc > 2 ? argv[2] : "";
+
+    for (int n = 10000; n <= maxEntries; n *= 10) {
+        Notification** out = new Notification*[n];
+        if (only.empty() || only == "legacy") runCase<LegacyNotificationQueue>("legacy", n, out);
+        if (only.empty() || only == "4-ary") runCase<NotificationQueue>("4-ary", n, out);
+        delete[] out;
+    }
+    return 0;
+}
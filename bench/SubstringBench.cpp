@@ -0,0 +1,122 @@
+#include "../include/Core.h"
+#include <cstdio>
+
+// ==================== CASELESS SUBSTRING BENCHMARK ====================
+// Counts the usernames containing each query, ignoring ASCII case, three ways:
+//
+//   copy   - the old search screen loop: lowercase a copy of every name,
+//            then string::find
+//   scalar - findCaselessScalar over the names packed into one buffer
+//   simd   - findCaseless (AVX2/SSE2) over the same buffer
+//
+// Every method walks all names, so the times compare the kernels rather
+// than early exits; UserSearchIndex answers the same queries from its
+// trigram lists without scanning.
+//
+// Usage: substring_bench [users] [reps]
+//   users defaults to 1000000 mixed-case names like "Alex_123"; each query
+//   is timed over reps (default 5) runs and the best run is reported.
+
+static const char* HANDLES[] = {
+    "Alex", "Sam", "Jordan", "Taylor", "Morgan", "Casey", "Riley", "Jamie",
+    "Avery", "Quinn", "Zara", "Noah", "Mia", "Leo", "Ivy", "Kai"
+};
+static const int HANDLE_COUNT = sizeof(HANDLES) / sizeof(HANDLES[0]);
+
+static const char* QUERIES[] = {
+    "alex", "ZARA_4", "_99", "9999", "12345", "rdan_1", "qqq", "i"
+};
+static const int QUERY_COUNT = sizeof(QUERIES) / sizeof(QUERIES[0]);
+
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static int countCopy(const vector<string>& names, const string& query) {
+    string lowerQuery = query;
+    for (char& c : lowerQuery) c = (char)tolower((unsigned char)c);
+    int count = 0;
+    for (const string& name : names) {
+        string lower = name;
+        for (char& c : lower) c = (char)tolower((unsigned char)c);
+        if (lower.find(lowerQuery) != string::npos) count++;
+    }
+    return count;
+}
+
+// Names are NUL-separated, so a match never spans two of them; after a hit
+// the scan resumes at the next name
+static int countPacked(const char* names, int size, const int* nameStart, int nameCount,
+                       const string& query, int (*find)(const char*, int, const char*, int)) {
+    int count = 0;
+    int offset = 0;
+    while (true) {
+        int hit = find(names + offset, size - offset, query.data(), (int)query.size());
+        if (hit < 0) break;
+        int name = (int)(upper_bound(nameStart, nameStart + nameCount + 1, offset + hit) - nameStart) - 1;
+        count++;
+        offset = nameStart[name + 1];
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    int userCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    if (userCount <= 0 || reps <= 0) {
+        cerr << "Error: users and reps must be positive" << endl;
+        return 1;
+    }
+
+    vector<string> names;
+    names.reserve(userCount);
+    for (int i = 0; i < userCount; i++) {
+        names.push_back(string(HANDLES[i % HANDLE_COUNT]) + "_" + to_string(i));
+    }
+
+    int* nameStart = new int[userCount + 1];
+    int size = 0;
+    for (int i = 0; i < userCount; i++) {
+        nameStart[i] = size;
+        size += (int)names[i].size() + 1;
+    }
+    nameStart[userCount] = size;
+    char* packed = new char[size];
+    for (int i = 0; i < userCount; i++) {
+        memcpy(packed + nameStart[i], names[i].c_str(), names[i].size() + 1);
+    }
+
+    printf("users: %d  packed bytes: %d  kernel: %s\n", userCount, size, caselessKernelName());
+    printf("%-8s %8s %10s %10s %10s %9s %8s\n", "query", "matches", "copy ms", "scalar ms", "simd ms",
+           "speedup", "GB/s");
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        string query = QUERIES[q];
+        double best[3] = { 1e30, 1e30, 1e30 };
+        int counts[3] = { 0, 0, 0 };
+        for (int r = 0; r < reps; r++) {
+            auto start = chrono::steady_clock::now();
+            counts[0] = countCopy(names, query);
+            best[0] = min(best[0], elapsedMs(start));
+
+            start = chrono::steady_clock::now();
+            counts[1] = countPacked(packed, size, nameStart, userCount, query, findCaselessScalar);
+            best[1] = min(best[1], elapsedMs(start));
+
+            start = chrono::steady_clock::now();
+            counts[2] = countPacked(packed, size, nameStart, userCount, query, findCaseless);
+            best[2] = min(best[2], elapsedMs(start));
+        }
+        if (counts[0] != counts[1] || counts[0] != counts[2]) {
+            cerr << "Error: match counts differ for \"" << query << "\": " << counts[0] << " / "
+                 << counts[1] << " / " << counts[2] << endl;
+            return 1;
+        }
+        printf("%-8s %8d %10.2f %10.2f %10.2f %8.1fx %8.2f\n", query.c_str(), counts[0], best[0], best[1],
+               best[2], best[0] / best[2], size / best[2] / 1e6);
+    }
+
+    delete[] packed;
+    delete[] nameStart;
+    return 0;
+}
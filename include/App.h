@@ -1,16 +1,8 @@
 #ifndef APP_H
 #define APP_H
 
-// ==================== STANDARD LIBRARIES ====================
-#include <iostream>
-#include <string>
-#include <vector>
-#include <ctime>
-#include <cstring>
-#include <algorithm>
-#include <fstream>
-#include <sstream>
-#include <chrono>  // ADD THIS LINE
+// ==================== CORE ====================
+#include "Core.h"
 
 // ==================== IMGUI ====================
 #include "../imgui/imgui.h"
@@ -20,15 +12,10 @@
 // ==================== GLFW ====================
 #include <GLFW/glfw3.h>
 
-using namespace std;
+// ==================== STANDARD LIBRARIES ====================
+#include <unordered_map>
 
 // ==================== ENUMS ====================
-enum NotificationType {
-    COMMENT = 1,
-    LIKE = 2,
-    FOLLOW = 3
-};
-
 enum Screen {
     LOGIN_SCREEN,
     FEED_SCREEN,
@@ -39,262 +26,63 @@ enum Screen {
     POST_DETAIL_SCREEN
 };
 
-// ==================== TIMESTAMP STRUCT ====================
-struct Timestamp {
-    int year, month, day;
-    int hour, minute, second;
-
-    Timestamp() : year(2025), month(1), day(1), hour(0), minute(0), second(0) {}
-    Timestamp(int y, int m, int d, int h, int min, int s)
-        : year(y), month(m), day(d), hour(h), minute(min), second(s) {}
-
-    bool isEarlier(const Timestamp& other) const {
-        if (year != other.year) return year < other.year;
-        if (month != other.month) return month < other.month;
-        if (day != other.day) return day < other.day;
-        if (hour != other.hour) return hour < other.hour;
-        if (minute != other.minute) return minute < other.minute;
-        return second < other.second;
-    }
-
-    bool isNewer(const Timestamp& other) const {
-        return !isEarlier(other) && !equals(other);
-    }
-
-    bool equals(const Timestamp& other) const {
-        return year == other.year && month == other.month && day == other.day &&
-               hour == other.hour && minute == other.minute && second == other.second;
-    }
-};
-
-// ==================== FORWARD DECLARATIONS ====================
-class User;
-class Post;
-class Comment;
-class Feed;
-class History;
-class Notification;
-class NotificationQueue;
-class UserDatabase;
-class PostDatabase;
-class UI;
-
-// ==================== COMMENT CLASS ====================
-class Comment {
-public:
-    int commentID;
-    int userID;
-    string username;
-    string content;
-    Timestamp timestamp;
-    Comment* next;
-
-    Comment(int id, int uid, const string& uname, const string& text, Timestamp ts);
-};
-
-// ==================== POST CLASS ====================
-class Post {
-public:
-    int postID;
-    int userID;
-    string username;
-    string content;
-    Timestamp timestamp;
-    int likes;
-    int commentCount;
-    Comment* comments;
-    Post* prev;
-    Post* next;
-
-    Post(int pid, int uid, const string& uname, const string& text, Timestamp ts);
-    ~Post();
-
-    void addLike();
-    void addComment(int uid, const string& uname, const string& text, Timestamp ts);
-    Comment* getComments() { return comments; }
-};
-
-// ==================== USER CLASS ====================
-class User {
-public:
-    int userID;
-    string username;
-    string password;
-    string bio;
-    int* followingList;
-    int* followersList;
-    int followingCount;
-    int followerCount;
-    int followingCapacity;
-    int followersCapacity;
-
-    User(int id, const string& uname, const string& pass, const string& userBio = "");
-    ~User();
-
-    bool addFollowing(int targetID);
-    bool removeFollowing(int targetID);
-    bool addFollower(int followerID);
-    bool removeFollower(int followerID);
-    bool isFollowing(int targetID) const;
-};
-
-// ==================== FEED CLASS ====================
-class FeedNode {
-public:
-    Post* post;
-    FeedNode* next;
-
-    FeedNode(Post* p) : post(p), next(nullptr) {}
-};
-
-class Feed {
+// ==================== RENDER CACHE ====================
+// Display strings and measured text layout for one post, comment or
+// notification, filled in lazily so a steady-state frame does no
+// formatting. The UI keeps them by item ID; the items themselves are
+// immutable once shown apart from likes and comment counts, which the
+// stats string is keyed on.
+struct RenderCache {
+    char timestamp[24];         // "YYYY-MM-DD HH:MM:SS"
+    char label[64];             // timestamp plus relative time, e.g. "... (3h ago)"
+    long long labelMinute;      // Minute `label` was computed for
+    char stats[48];             // "Likes: N | Comments: M" (posts only)
+    int statsLikes;
+    int statsComments;
+    float wrapWidth;            // Width `wrappedHeight` was measured at
+    float wrappedHeight;
+    bool valid;                 // `timestamp` is filled in
+
+    RenderCache()
+        : labelMinute(-1), statsLikes(-1), statsComments(-1),
+          wrapWidth(-1.0f), wrappedHeight(0.0f), valid(false) {}
+};
+
+// ==================== ROW LAYOUT ====================
+// A virtualized list of cards, each as tall as its wrapped text plus a fixed
+// chrome (name, timestamp, buttons, padding). Row tops are prefix sums of
+// those heights, rebuilt when the rows or the wrap width change; the rows in
+// view are found by binary search. The chrome is measured from the rows as
+// they are drawn, so it follows whatever the card lays out.
+class RowLayout {
 private:
-    FeedNode* head;
-    int count;
-
-public:
-    Feed();
-    ~Feed();
+    vector<float> textHeights;
+    vector<float> offsets;      // Top of each row from the list start; back() is the total
+    float wrapWidth;            // Width textHeights were measured at
+    float chrome;               // Card height besides its text
+    float measuredChrome;       // From the rows drawn this frame
+    float gap;                  // Space after each card
+    float listTop;              // Cursor Y the list starts at this frame
 
-    void clear();
-    void insertSorted(Post* post);
-    void generateFeed(User* currentUser, PostDatabase* allPosts);
-    FeedNode* getHead() { return head; }
-};
+    void layout();
 
-// ==================== HISTORY CLASS ====================
-class HistoryNode {
 public:
-    int userID;
-    int postID;
-    HistoryNode* next;
+    RowLayout(float estimatedChrome, float rowGap);
 
-    HistoryNode(int uid, int pid) : userID(uid), postID(pid), next(nullptr) {}
-};
+    bool needsBuild(float width) const { return width != wrapWidth; }
+    // Rebuild: clear, then add every row's text height in order
+    void clear(float width);
+    void add(float textHeight);
+    int size() const { return (int)textHeights.size(); }
 
-class History {
-private:
-    HistoryNode* top;
-    int count;
-    static const int MAX_HISTORY = 50;
-
-public:
-    History();
-    ~History();
-
-    void push(int userID, int postID);
-    bool pop(int& userID, int& postID);
-    bool peek(int& userID, int& postID);
-    void clear();
-    bool isEmpty() { return top == nullptr; }
-};
-
-// ==================== NOTIFICATION CLASS ====================
-class Notification {
-public:
-    int notificationID;
-    NotificationType type;
-    int fromUserID;
-    string fromUsername;
-    int postID;
-    string message;
-    Timestamp timestamp;
-    bool isRead;
-
-    Notification();
-    Notification(int id, NotificationType t, int fromID, const string& fromUser,
-                 int pID, const string& msg, Timestamp ts);
-
-    bool hasHigherPriority(const Notification& other) const;
-};
-
-class NotificationQueue {
-private:
-    Notification** heap;
-    int capacity;
-    int size;
-    int nextID;
-
-    int parent(int i) { return (i - 1) / 2; }
-    int leftChild(int i) { return 2 * i + 1; }
-    int rightChild(int i) { return 2 * i + 2; }
-    void swap(int i, int j);
-    void heapifyUp(int index);
-    void heapifyDown(int index);
-
-public:
-    NotificationQueue(int cap = 200);
-    ~NotificationQueue();
-
-    void addNotification(NotificationType type, int fromUserID, const string& fromUsername,
-                         int postID, const string& message, Timestamp timestamp);
-    void getAllNotifications(Notification** arr, int& count);
-    void clearAll();
-    bool isEmpty() { return size == 0; }
-};
-
-// ==================== USER DATABASE CLASS ====================
-class UserNode {
-public:
-    User* user;
-    UserNode* left;
-    UserNode* right;
-
-    UserNode(User* u) : user(u), left(nullptr), right(nullptr) {}
-};
-
-class UserDatabase {
-private:
-    UserNode* root;
-    int nextUserID;
-
-    UserNode* insertNode(UserNode* node, User* user);
-    UserNode* searchByID(UserNode* node, int userID);
-    User* searchByUsername(UserNode* node, const string& username);
-    void destroyTree(UserNode* node);
-    void collectUsers(UserNode* node, User** arr, int& index);
-
-public:
-    UserDatabase();
-    ~UserDatabase();
-
-    User* registerUser(const string& username, const string& password, const string& bio = "");
-    User* login(const string& username, const string& password);
-    User* searchByID(int userID);
-    User* searchByUsername(const string& username);
-    void getAllUsers(User** arr, int& count);
-    void generateDummyUsers();
-    
-    // ADD THESE FILE HANDLING METHODS:
-    void saveToFile(const string& filename);
-    void loadFromFile(const string& filename);
-    void saveConnectionsToFile(const string& filename);
-    void loadConnectionsFromFile(const string& filename);
-};
-
-// ==================== POST DATABASE CLASS ====================
-class PostDatabase {
-private:
-    Post* head;
-    Post* tail;
-    int nextPostID;
-    int nextCommentID;
-
-public:
-    PostDatabase();
-    ~PostDatabase();
-
-    Post* createPost(int userID, const string& username, const string& content, Timestamp ts);
-    bool deletePost(int postID);
-    Post* findPost(int postID);
-    Post* getHead() { return head; }
-    int getNextCommentID() { return nextCommentID++; }
-    void generateDummyPosts(UserDatabase* userDB);
-    void clearAll();
-    
-    // ADD THESE FILE HANDLING METHODS:
-    void saveToFile(const string& filename);
-    void loadFromFile(const string& filename);
+    // Rows [first, last) overlap the visible part of the window
+    void begin(int& first, int& last);
+    // Moves the cursor to the row and returns its card height
+    float beginRow(int row);
+    // Call with the cursor just below the row's content
+    void endRow(int row, float bottomPadding);
+    // Leaves the cursor below the last row
+    void end();
 };
 
 // ==================== UI CLASS ====================
@@ -310,6 +98,7 @@ private:
     NotificationQueue* notifications;
     History* history;
     Feed* feed;
+    TypeaheadSearch* typeahead;
 
     char usernameInput[65];
     char passwordInput[65];
@@ -322,10 +111,60 @@ private:
 
     User* searchResults[100];
     int searchResultCount;
+    int typeaheadVersion;       // Last results taken from typeahead
+    bool searchPostsMode;       // Search screen: users or post text
+    Post* postResults[100];
+    int postResultCount;
+    string postResultsQuery;
+    int postResultsVersion;     // Re-run when posts are added or deleted
+    string trendingTags[10];    // Shown while the posts query is empty
+    int trendingTagCount;
+    User* suggestions[10];      // Who to follow, while the users query is empty
+    int suggestionConnections[10];
+    int suggestionCount;
+    int suggestionsUserID;      // Whose suggestions, and User::followVersion
+    int suggestionsFollowVersion; // then; either changing means recompute
+    string connectionsLabel;    // Profile: followed by / mutual followers
+    int connectionsKey[3];      // Profile and viewer IDs and User::followVersion
+
+    // Row sources for the virtualized profile and comment lists
+    vector<Post*> profilePosts;
+    int profilePostsUserID;
+    int profilePostsVersion;
+    vector<Comment*> commentRows;
+    int commentRowsPostID;
+    int commentRowsCount;
+    vector<Notification*> notificationRows;    // Room for a full inbox
+    RowLayout feedLayout;
+    RowLayout profileLayout;
+    RowLayout postResultsLayout;
+    RowLayout commentLayout;
+
+    // Render caches by post ID, (post ID, comment ID) and notification ID.
+    // Posts and comments are dropped whenever the post set changes, so
+    // deleted posts don't linger; notifications once the map outgrows the
+    // inbox shown.
+    unordered_map<int, RenderCache> postCaches;
+    unordered_map<long long, RenderCache> commentCaches;
+    unordered_map<int, RenderCache> notificationCaches;
+    int renderCachesVersion;
+
+    long long nowMinute;    // Wall-clock minute, refreshed once per frame
+    bool showProfiler;      // F3 toggles the timing overlay
 
     void showErrorMessage(const char* msg);
     Timestamp getCurrentTime();
-    string timestampToString(const Timestamp& ts);
+    RenderCache& postCache(const Post* post);
+    RenderCache& commentCache(const Post* post, const Comment* comment);
+    RenderCache& notificationCache(const Notification* notification);
+    const char* timeLabel(RenderCache& cache, const Timestamp& ts);
+    const char* statsLabel(RenderCache& cache, int likes, int comments);
+    float textHeight(const string& text, RenderCache& cache, float wrapWidth);
+    void wrappedText(const string& text, RenderCache& cache, float wrapWidth);
+    void renderProfilerOverlay();
+    void renderPostSearchResults();
+    void renderSuggestions();
+    const char* commonConnectionsLabel();
 
 public:
     UI(UserDatabase* users, PostDatabase* posts, NotificationQueue* notifs, History* hist);
@@ -346,8 +185,4 @@ public:
     void populateDummyFeed();   // <<< declaration fixes the error
 };
 
-// ==================== UTILITY FUNCTIONS ====================
-Timestamp getCurrentTimestamp();
-string timestampToString(const Timestamp& ts);
-
 #endif // APP_H
@@ -0,0 +1,1251 @@
+#ifndef CORE_H
+#define CORE_H
+
+// Data and engine layer: users, posts, feed, history and notifications.
+// Depends only on the standard library so it can be built into a headless
+// static library (see `make core`); GUI code includes App.h instead.
+
+// ==================== STANDARD LIBRARIES ====================
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>  // ADD THIS LINE
+
+using namespace std;
+
+// ==================== ENUMS ====================
+enum NotificationType {
+    COMMENT = 1,
+    LIKE = 2,
+    FOLLOW = 3,
+    MENTION = 4
+};
+
+// ==================== TIMESTAMP STRUCT ====================
+struct Timestamp {
+    int year, month, day;
+    int hour, minute, second;
+
+    Timestamp() : year(2025), month(1), day(1), hour(0), minute(0), second(0) {}
+    Timestamp(int y, int m, int d, int h, int min, int s)
+        : year(y), month(m), day(d), hour(h), minute(min), second(s) {}
+
+    bool isEarlier(const Timestamp& other) const {
+        if (year != other.year) return year < other.year;
+        if (month != other.month) return month < other.month;
+        if (day != other.day) return day < other.day;
+        if (hour != other.hour) return hour < other.hour;
+        if (minute != other.minute) return minute < other.minute;
+        return second < other.second;
+    }
+
+    bool isNewer(const Timestamp& other) const {
+        return !isEarlier(other) && !equals(other);
+    }
+
+    bool equals(const Timestamp& other) const {
+        return year == other.year && month == other.month && day == other.day &&
+               hour == other.hour && minute == other.minute && second == other.second;
+    }
+
+    // Packs the fields into 56 bits so that comparing packed values gives the
+    // same order as isEarlier(). Fields are biased so the slightly out-of-range
+    // values produced by the "hours ago" helpers still sort correctly.
+    uint64_t packed() const {
+        return ((uint64_t)((year + 32768) & 0xFFFF) << 40) |
+               ((uint64_t)((month + 128) & 0xFF) << 32) |
+               ((uint64_t)((day + 128) & 0xFF) << 24) |
+               ((uint64_t)((hour + 128) & 0xFF) << 16) |
+               ((uint64_t)((minute + 128) & 0xFF) << 8) |
+               (uint64_t)((second + 128) & 0xFF);
+    }
+
+    static Timestamp unpack(uint64_t p) {
+        return Timestamp((int)((p >> 40) & 0xFFFF) - 32768, (int)((p >> 32) & 0xFF) - 128,
+                         (int)((p >> 24) & 0xFF) - 128, (int)((p >> 16) & 0xFF) - 128,
+                         (int)((p >> 8) & 0xFF) - 128, (int)(p & 0xFF) - 128);
+    }
+};
+
+// ==================== FORWARD DECLARATIONS ====================
+class User;
+class Post;
+class Comment;
+class Feed;
+class History;
+class Notification;
+class NotificationQueue;
+class UserDatabase;
+class PostDatabase;
+class UI;
+
+// ==================== COMMENT CLASS ====================
+class Comment {
+public:
+    int commentID;
+    int userID;
+    string username;
+    string content;
+    Timestamp timestamp;
+    Comment* next;
+
+    Comment(int id, int uid, const string& uname, const string& text, Timestamp ts);
+};
+
+// ==================== POST CLASS ====================
+class Post {
+public:
+    int postID;
+    int userID;
+    string username;
+    string content;
+    Timestamp timestamp;
+    int likes;
+    int commentCount;
+    Comment* comments;
+    Post* prev;
+    Post* next;
+    int searchUnit;         // Newest PostSearchIndex unit of the post or its comments; -1 = none
+
+    Post(int pid, int uid, const string& uname, const string& text, Timestamp ts);
+    ~Post();
+
+    void addLike();
+    void addComment(int uid, const string& uname, const string& text, Timestamp ts);
+    Comment* getComments() { return comments; }
+};
+
+// ==================== USER CLASS ====================
+class User {
+public:
+    int userID;
+    string username;
+    string password;
+    string bio;
+    int* followingList;
+    int* followersList;
+    int followingCount;
+    int followerCount;
+    int followingCapacity;
+    int followersCapacity;
+    // Written by GraphAnalytics: PageRank scaled so the average user is 1.0
+    // (0 until analytics has run), and the smallest user ID in this user's
+    // weakly connected component
+    float influence;
+    int componentID;
+    // Bumped by every follow and unfollow, so anything cached from the
+    // follow graph can tell when to recompute
+    static atomic<int> followVersion;
+
+    User(int id, const string& uname, const string& pass, const string& userBio = "");
+    ~User();
+
+    bool addFollowing(int targetID);
+    bool removeFollowing(int targetID);
+    bool addFollower(int followerID);
+    bool removeFollower(int followerID);
+    bool isFollowing(int targetID) const;
+    bool isFollowedBy(int userID) const;
+    // Followers of this user whom viewer follows ("followed by people you
+    // follow"), and followers this user shares with other. The first maxIDs
+    // IDs go to ids; the return value is the full count.
+    int getFollowedByFollowing(const User* viewer, int* ids, int maxIDs) const;
+    int getMutualFollowers(const User* other, int* ids, int maxIDs) const;
+};
+
+// Search order: most influential first, then most followed. Until graph
+// analytics runs every influence is 0 and this is follower count alone.
+inline bool rankedAbove(const User* a, const User* b) {
+    if (a->influence != b->influence) return a->influence > b->influence;
+    return a->followerCount > b->followerCount;
+}
+
+// ==================== FEED CLASS ====================
+class FeedNode {
+public:
+    Post* post;
+    FeedNode* next;
+
+    FeedNode(Post* p) : post(p), next(nullptr) {}
+};
+
+// Chronological by default. Ranked mode scores recent posts from followed
+// users by freshness, likes, comments and author affinity, and keeps the best.
+class Feed {
+public:
+    static const int FEED_SIZE = 20;
+    static const int MAX_CANDIDATES = 10000;    // Newest posts considered when ranking
+
+private:
+    FeedNode* head;
+    FeedNode* tail;
+    int count;
+    bool ranked;
+
+    // Random-access view of the list for virtualized rendering
+    Post** index;
+    int indexCapacity;
+
+    // Ranked mode candidates, one array per field so scoring streams
+    // through contiguous floats. Allocated on first use.
+    Post** candidates;
+    float* candidateAge;        // Hours
+    float* candidateLikes;
+    float* candidateComments;
+    float* candidateAffinity;
+    float* candidateScore;
+    int* candidateOrder;
+
+    // Followed authors -> affinity (open addressing, 0 = empty slot)
+    int* followKeys;
+    float* followAffinity;
+    int followTableSize;
+
+    void rebuildIndex();
+    void append(Post* post);
+    void buildFollowTable(User* currentUser);
+    float lookupAffinity(int authorID);
+    void generateRankedFeed(User* currentUser, PostDatabase* allPosts);
+
+public:
+    Feed();
+    ~Feed();
+
+    void clear();
+    void insertSorted(Post* post);
+    void generateFeed(User* currentUser, PostDatabase* allPosts);
+    void setRanked(bool on) { ranked = on; }
+    bool isRanked() { return ranked; }
+    FeedNode* getHead() { return head; }
+    int getCount() { return count; }
+    Post* getPost(int i) { return index[i]; }
+};
+
+// ==================== HISTORY CLASS ====================
+class HistoryNode {
+public:
+    int userID;
+    int postID;
+    HistoryNode* next;
+
+    HistoryNode(int uid, int pid) : userID(uid), postID(pid), next(nullptr) {}
+};
+
+class History {
+private:
+    HistoryNode* top;
+    int count;
+    static const int MAX_HISTORY = 50;
+
+public:
+    History();
+    ~History();
+
+    void push(int userID, int postID);
+    bool pop(int& userID, int& postID);
+    bool peek(int& userID, int& postID);
+    void clear();
+    bool isEmpty() { return top == nullptr; }
+};
+
+// ==================== NOTIFICATION CLASS ====================
+class Notification {
+public:
+    int notificationID;
+    NotificationType type;
+    int toUserID;
+    int fromUserID;
+    string fromUsername;
+    int postID;
+    string message;
+    Timestamp timestamp;
+    bool isRead;
+
+    Notification();
+    Notification(int id, NotificationType t, int toID, int fromID, const string& fromUser,
+                 int pID, const string& msg, Timestamp ts);
+
+    bool hasHigherPriority(const Notification& other) const;
+    uint64_t priorityKey() const { return ((uint64_t)type << 56) | timestamp.packed(); }
+};
+
+// Heap entry: the priority key is stored inline so sifting never touches the
+// notifications themselves. Smaller key = higher priority.
+struct NotificationHeapEntry {
+    uint64_t key;
+    int slot;
+};
+
+// Each recipient has its own 4-ary heap and unread counter
+struct NotificationInbox {
+    int userID;                     // 0 = empty bucket
+    NotificationHeapEntry* heap;
+    int size;
+    int capacity;
+    int unread;
+    bool loaded;                    // False until replayed from the segment
+};
+
+// Segment offsets of the records for one user whose inbox isn't loaded yet
+struct SegmentIndexEntry {
+    int userID;                     // 0 = empty bucket
+    long long* offsets;             // In file order
+    int count;
+    int capacity;
+};
+
+// Record kinds in the append-only notification segment
+enum NotificationRecordKind {
+    RECORD_ADD = 1,
+    RECORD_READ = 2,
+    RECORD_READ_ALL = 3,
+    RECORD_CLEAR = 4      // userID 0 clears every inbox
+};
+
+// Event handed from a producer thread to the consumer
+struct PendingNotification {
+    int toUserID;
+    NotificationType type;
+    int fromUserID;
+    string fromUsername;
+    int postID;
+    string message;
+    Timestamp timestamp;
+};
+
+// Bounded lock-free multi-producer / single-consumer ring. Every cell carries a
+// sequence number telling producers and the consumer whose turn it is, so
+// producers only contend on one fetch-and-CAS of the enqueue position.
+class NotificationRing {
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        PendingNotification value;
+    };
+
+    Cell* cells;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;  // Consumer only
+
+public:
+    NotificationRing(size_t cap);
+    ~NotificationRing();
+
+    bool push(PendingNotification& item);   // Any thread; moves from item, false if full
+    bool pop(PendingNotification& item);    // Consumer thread only
+};
+
+// All members except postNotification() must be called from the consumer
+// (UI) thread. Background producers call postNotification(), and the consumer
+// moves their events into the inboxes with drainPending().
+class NotificationQueue {
+private:
+    static const int SLAB_SIZE = 64;
+    static const int HEAP_ARITY = 4;
+
+    Notification** slabs;   // Fixed-size blocks, notifications stored by value
+    int slabCount;          // Entries in slabs; grows as slots are handed out
+    int slotsUsed;          // High-water mark of handed-out slots
+    int* freeSlots;         // Slots released by eviction and clearInbox()/clearAll()
+    int freeCount;
+    int inboxLimit;         // Most notifications one inbox keeps
+    int size;
+    int nextID;
+
+    // Per-user inboxes (open addressing on userID)
+    NotificationInbox* inboxes;
+    int inboxBuckets;
+    int inboxUsed;
+
+    NotificationRing pending;
+
+    // Append-only segment; inboxes are replayed from it on first access
+    string segmentPath;
+    ofstream segment;
+    long long segmentSize;  // Offset of the next record
+
+    // Where each unloaded user's records are (open addressing on userID).
+    // Built by one scan of the segment on the first replay, then kept up
+    // to date by appendRecord().
+    SegmentIndexEntry* segmentIndex;
+    int segmentIndexBuckets;
+    int segmentIndexUsed;
+    bool segmentIndexed;
+
+    Notification& slot(int index) { return slabs[index / SLAB_SIZE][index % SLAB_SIZE]; }
+    int parent(int i) { return (i - 1) / HEAP_ARITY; }
+    int firstChild(int i) { return HEAP_ARITY * i + 1; }
+    void heapifyUp(NotificationInbox& inbox, int index);
+    void heapifyDown(NotificationInbox& inbox, int index);
+    int allocateSlot();
+    void growSlabs();
+    void evictOldest(NotificationInbox& inbox, int index);
+    void releaseInbox(NotificationInbox& inbox);
+    NotificationInbox* findInbox(int userID, bool create);
+    NotificationInbox* loadedInbox(int userID);
+    void growInboxes();
+    void insertNotification(NotificationInbox& inbox, int id, NotificationType type,
+                            int fromUserID, const string& fromUsername, int postID,
+                            const string& message, Timestamp timestamp, bool isRead);
+    SegmentIndexEntry* findIndexEntry(int userID, bool create);
+    void growSegmentIndex();
+    void indexRecord(NotificationRecordKind kind, int userID, long long offset);
+    void indexSegment();
+    void replaySegment(NotificationInbox& inbox);
+    void appendRecord(NotificationRecordKind kind, int userID, int notificationID,
+                      const Notification* n = nullptr);
+
+public:
+    // Each inbox keeps its newest inboxCap notifications; older ones are
+    // evicted from memory (the segment still has them)
+    NotificationQueue(int inboxCap = 200, int pendingCap = 1024);
+    ~NotificationQueue();
+
+    void addNotification(int toUserID, NotificationType type, int fromUserID,
+                         const string& fromUsername, int postID, const string& message,
+                         Timestamp timestamp);
+    bool postNotification(int toUserID, NotificationType type, int fromUserID,
+                          const string& fromUsername, int postID, const string& message,
+                          Timestamp timestamp);
+    int drainPending();
+    // Highest priority first; writes at most maxCount to arr
+    void getAllNotifications(int userID, Notification** arr, int& count, int maxCount);
+    void markAsRead(Notification* notification);
+    void markAllRead(int userID);
+    int getUnreadCount(int userID);
+    void clearInbox(int userID);
+    void clearAll();
+    bool isEmpty() { return size == 0; }
+    int getInboxLimit() { return inboxLimit; }
+
+    void openSegment(const string& filename);
+};
+
+// ==================== CASELESS SUBSTRING SCAN ====================
+// Offset of the first ASCII case-insensitive occurrence of needle in
+// haystack[0..length), or -1. Never allocates. Uses AVX2 or SSE2 when the
+// CPU has them (chosen on first call) and a scalar loop otherwise; other
+// bytes, including UTF-8, must match exactly.
+int findCaseless(const char* haystack, int length, const char* needle, int needleLength);
+int findCaselessScalar(const char* haystack, int length, const char* needle, int needleLength);
+const char* caselessKernelName();   // "avx2", "sse2" or "scalar"
+
+// ==================== SORTED ID INTERSECTION ====================
+// Common elements of two ascending, duplicate-free ID lists. Writes the
+// first maxOut of them to out (which may be nullptr when maxOut is 0) and
+// returns how many there are in all. When one list is much shorter, each
+// of its IDs is found in the other by galloping (exponential then binary
+// search), O(small * log(large / small)); otherwise the lists are merged,
+// four IDs against four at a time with SSE2 where available.
+int intersectSorted(const int* a, int aCount, const int* b, int bCount, int* out, int maxOut);
+int intersectSortedScalar(const int* a, int aCount, const int* b, int bCount, int* out, int maxOut);
+
+// First index >= start of ascending values whose value is >= target (count
+// if none): doubling steps from start bracket it, then a binary search
+// inside the last step. Cheap when the answer is near start, which is how
+// intersections walk a list.
+inline int gallopSearch(const int* values, int count, int start, int target) {
+    if (start >= count || values[start] >= target) return start;
+    int low = start, step = 1, high = start + 1;
+    while (high < count && values[high] < target) {
+        low = high;
+        step <<= 1;
+        high = start + step;
+    }
+    if (high > count) high = count;
+    return (int)(lower_bound(values + low + 1, values + high, target) - values);
+}
+
+// ==================== USER SEARCH INDEX ====================
+// Trigram index over lowercased usernames for substring and prefix search.
+// Names are padded with two start markers, so "^^a" and "^ab" trigrams make
+// prefix queries of any length index lookups too; bigrams cover one and two
+// character substrings. Users are numbered in rankedAbove() order
+// (influence, then follower count) when ranked, so walking the posting lists
+// in order visits the best matches first. A top-k query takes the first
+// CANDIDATE_FACTOR * k hits and returns the best k of those by current
+// rankedAbove(), so users who gained followers since the last rerank() can
+// still make the cut; UserDatabase reranks once enough follows have
+// happened for that to stop being enough. Users added later are appended
+// (they have no followers yet).
+class UserSearchIndex {
+public:
+    static const int CANDIDATE_FACTOR = 4;
+
+
+private:
+    struct PostingList {
+        uint32_t key;       // Trigram or tagged bigram; EMPTY_KEY marks a free bucket
+        int* docs;          // Ascending document numbers
+        int count;
+        int capacity;
+    };
+
+    static const uint32_t EMPTY_KEY = 0xFFFFFFFFu;
+    static const char START_MARKER = '\x02';
+
+    PostingList* table;     // Open addressing, linear probing
+    int tableSize;          // Power of two
+    int tableUsed;
+
+    User** docs;            // Document number -> user
+    int* nameStart;         // Offsets into names, docCount + 1 entries
+    int docCount;
+    int docCapacity;
+    char* names;            // Lowercased, NUL-terminated names back to back
+    int namesSize;
+    int namesCapacity;
+
+    User** candidates;      // Hits in document order, before the final sort
+    int candidateCapacity;
+    int rankedFollowVersion;    // User::followVersion at the last rerank()
+
+    PostingList* findList(uint32_t key, bool create);
+    void growTable();
+    void appendDoc(User* user);
+    void indexDoc(int doc);
+    void addPosting(uint32_t key, int doc);
+    bool matches(int doc, const string& query, bool prefixOnly);
+
+public:
+    UserSearchIndex();
+    ~UserSearchIndex();
+
+    void add(User* user);
+    void rerank();          // Renumber by current influence and follower counts
+    void clear();
+    int search(const string& query, bool prefixOnly, User** results, int maxResults);
+    int getCount() { return docCount; }
+    int getRankedFollowVersion() { return rankedFollowVersion; }
+};
+
+// ==================== WHO TO FOLLOW ====================
+// Friends-of-friends suggestions: counts, for every account the people a
+// user follows are following, how many of them do, and returns the largest
+// counts. Counters live in a dense array indexed by userID - FIRST_USER_ID
+// with a list of the slots touched, so a query allocates nothing once the
+// arrays have grown and only clears what it used. Users whose follows
+// lead to many second-degree edges are split across threads, each counting
+// into its own array; the arrays are merged afterwards.
+class FollowRecommender {
+public:
+    static const int FIRST_USER_ID = 1001;
+    static const int MAX_WORKERS = 8;
+    static const int PARALLEL_EDGES = 1 << 18;  // Below this one thread is faster
+
+private:
+    struct Scratch {
+        int* counts;        // By userID - FIRST_USER_ID; zero between queries
+        int* touched;       // Slots whose count left zero
+        int touchedCount;
+    };
+
+    Scratch scratch[MAX_WORKERS];
+    int capacity;           // Slots in each counts array
+    int workersReady;       // Scratch entries allocated at this capacity
+    User** followees;
+    int followeesCapacity;
+    float* influence;       // By slot, from the last graph analytics run
+    int influenceSlots;
+
+    void ensureCapacity(int slots, int workers);
+    static void countRange(Scratch* s, User** list, int begin, int end, int slots);
+
+public:
+    FollowRecommender();
+    ~FollowRecommender();
+
+    // Most shared connections first, then most influential, then lower ID;
+    // connections may be nullptr
+    int recommend(UserDatabase* users, User* user, User** results, int* connections, int maxResults);
+    // Influence by userID - FIRST_USER_ID, copied; users past slots count as 0
+    void setInfluence(const float* scores, int slots);
+};
+
+// ==================== GRAPH ANALYTICS ====================
+// Batch jobs over the whole follow graph: PageRank (influence) and weakly
+// connected components. snapshot() copies followersList into CSR arrays
+// (users in ID order, each with the users following them), compute() runs
+// both on up to MAX_WORKERS threads, and publish() writes User::influence
+// and User::componentID back. snapshot() and publish() need the users to
+// themselves; compute() touches only the snapshot, so it may run on another
+// thread while users change (users are never deleted, so the snapshot's
+// User pointers stay valid). run() does all three.
+struct GraphAnalyticsReport {
+    int users;
+    long long edges;
+    int iterations;         // PageRank iterations run
+    double residual;        // L1 change of the last one
+    int components;
+    int largestComponent;
+    double seconds;
+};
+
+class GraphAnalytics {
+public:
+    static const int MAX_WORKERS = 8;
+    static const int PARALLEL_WORK = 1 << 16;  // Users plus edges; below this one thread is faster
+    static const int MAX_ITERATIONS = 100;
+    static constexpr double DAMPING = 0.85;
+    static constexpr double TOLERANCE = 1e-6;   // L1 change per iteration; ranks sum to 1
+
+private:
+    int nodeCount;
+    long long edgeCount;
+    User** nodes;           // By node: users in ID order
+    long long* inOffsets;   // nodeCount + 1; in-edges of v are inSources[inOffsets[v]..inOffsets[v + 1])
+    int* inSources;         // Followers of each node, as nodes
+    int* outDegree;         // Followees of each node that are in the snapshot
+    double* rank;
+    int* component;         // Smallest node in the component
+    int workers;
+    int bounds[MAX_WORKERS + 1];    // Node ranges with about the same number of in-edges
+    int iterations;
+    double residual;
+    chrono::steady_clock::time_point started;
+
+    void release();
+    void buildSnapshot(UserDatabase* users);
+    void splitWork(int threads);
+    int computePageRank(double& residual);
+    void computeComponents();
+
+public:
+    GraphAnalytics();
+    ~GraphAnalytics();
+
+    // threads <= 0 uses every hardware thread. Returns false if there are no
+    // users, leaving nothing to compute or publish.
+    bool snapshot(UserDatabase* users, int threads);
+    void compute();
+    // Writes the results back and frees the snapshot. report may be nullptr;
+    // its seconds run from snapshot().
+    void publish(GraphAnalyticsReport* report);
+    bool run(UserDatabase* users, int threads, GraphAnalyticsReport* report);
+    double elapsedSeconds() const;
+};
+
+// ==================== USER DATABASE CLASS ====================
+class UserNode {
+public:
+    User* user;
+    UserNode* left;
+    UserNode* right;
+    int height;     // AVL height; IDs arrive in sorted order on load
+
+    UserNode(User* u) : user(u), left(nullptr), right(nullptr), height(1) {}
+};
+
+class UserDatabase {
+private:
+    UserNode* root;
+    int nextUserID;
+    int userCount;
+    // Follow changes before search reranks: this many, or a tenth of the
+    // users if more (a rerank takes about 1 s at 1M users)
+    static const int RERANK_MIN_CHANGES = 100;
+    UserSearchIndex searchIndex;
+    FollowRecommender recommender;
+    // Exact usernames (open addressing, nullptr = empty), for login,
+    // registration and @mentions
+    User** nameTable;
+    int nameTableSize;
+
+    int height(UserNode* node) { return node ? node->height : 0; }
+    UserNode* rotateLeft(UserNode* node);
+    UserNode* rotateRight(UserNode* node);
+    UserNode* rebalance(UserNode* node);
+    UserNode* insertNode(UserNode* node, User* user);
+    UserNode* searchByID(UserNode* node, int userID);
+    User* findName(const string& username);
+    void addName(User* user);
+    void destroyTree(UserNode* node);
+    void collectUsers(UserNode* node, User** arr, int& index);
+
+public:
+    UserDatabase();
+    ~UserDatabase();
+
+    User* registerUser(const string& username, const string& password, const string& bio = "");
+    User* login(const string& username, const string& password);
+    User* searchByID(int userID);
+    User* searchByUsername(const string& username);
+    void getAllUsers(User** arr, int& count);
+    int getUserCount() { return userCount; }
+    int getNextUserID() { return nextUserID; }
+    // Case-insensitive; in rankedAbove() order. Returns the number found.
+    int searchUsers(const string& query, User** results, int maxResults, bool prefixOnly = false);
+    void refreshSearchRanking() { searchIndex.rerank(); }
+    // Accounts followed by the most people this user follows, excluding
+    // the user and everyone they already follow; see FollowRecommender
+    int recommendFollows(User* user, User** results, int* connections, int maxResults);
+    // Recomputes every user's influence and component (see GraphAnalytics),
+    // then reranks search and recommendations by them. report may be nullptr.
+    bool runGraphAnalytics(int threads, GraphAnalyticsReport* report);
+    // The last step of runGraphAnalytics, for a job whose compute() ran
+    // elsewhere: publishes it and reranks
+    void publishGraphAnalytics(GraphAnalytics* analytics, GraphAnalyticsReport* report);
+    void generateDummyUsers();
+    
+    // ADD THESE FILE HANDLING METHODS:
+    void saveToFile(const string& filename);
+    void loadFromFile(const string& filename);
+    void saveConnectionsToFile(const string& filename);
+    void loadConnectionsFromFile(const string& filename);
+};
+
+// ==================== TYPEAHEAD SEARCH ====================
+// Search-as-you-type for the user search box. setQuery() only records the
+// text; a worker thread waits until typing pauses for debounceMs, runs the
+// query and publishes the results for poll(), raising ChangeSignal so an
+// idle render loop picks them up. A query containing the previous one can
+// only match a subset of its users, so while the previous result list is
+// complete (under CACHE_RESULTS) the worker filters it instead of asking
+// the index again.
+//
+// The worker reads the UserDatabase while it searches: anything that
+// changes users (register, follow, load) must hold getDataLock(). The UI
+// holds it for the whole of render().
+class TypeaheadSearch {
+public:
+    static const int MAX_RESULTS = 100;     // Published to poll()
+
+private:
+    static const int CACHE_RESULTS = 1000;  // Kept by the worker for narrowing
+
+    UserDatabase* users;
+    int debounceMs;
+    mutex dataLock;
+
+    // Shared with the worker, under stateLock
+    mutex stateLock;
+    condition_variable wake;
+    bool stopping;
+    bool hasPending;
+    bool pendingImmediate;
+    string pendingQuery;
+    chrono::steady_clock::time_point pendingSince;  // Last keystroke
+    User* results[MAX_RESULTS];
+    int resultCount;
+    int resultVersion;
+
+    // Worker only
+    string cacheQuery;
+    User** cache;
+    int cacheCount;
+    bool cacheComplete;
+
+    thread worker;          // Last, so it starts after the rest is set up
+
+    void run();
+    int search(const string& query, User** found);
+
+public:
+    TypeaheadSearch(UserDatabase* userDB, int debounce = 80);
+    ~TypeaheadSearch();
+
+    // immediate skips the debounce (search button, cleared box)
+    void setQuery(const string& query, bool immediate = false);
+    // Copies results newer than version and updates it; false if none
+    bool poll(int& version, User** out, int& count);
+    mutex& getDataLock() { return dataLock; }
+};
+
+// ==================== POST SEARCH INDEX ====================
+// Inverted index over post and comment text. Each indexed text (a post body
+// or one comment) is a "unit" numbered in insertion order, so postings only
+// ever append: a term's list is a byte stream of varint-coded
+//   unit delta, term frequency, position deltas...
+// Deleting a post marks its units dead; lists are re-encoded without them
+// once dead units outnumber live ones.
+//
+// Query syntax: words must all appear, "a OR b" takes either, -word excludes,
+// "quoted words" must appear next to each other in one text. Posts are ranked
+// by BM25 summed over the body and comments, newest first on ties.
+class PostSearchIndex {
+public:
+    struct Hit {
+        int postID;
+        double score;
+        Post* post;
+    };
+
+private:
+    struct TermPostings {
+        unsigned char* bytes;
+        int size;
+        int capacity;
+        int lastUnit;       // Previous unit appended, for delta coding
+        int df;             // Units holding the term (dead ones until compaction)
+    };
+
+    // Term dictionary: open addressing over term numbers, -1 = empty
+    int* termTable;
+    int termTableSize;
+    string* termText;
+    TermPostings* postings;
+    int termCount;
+    int termCapacity;
+
+    // Units
+    Post** unitPost;
+    int* unitLength;        // Tokens, for BM25 length normalization
+    bool* unitAlive;
+    int* unitNext;          // Previous unit of the same post (from Post::searchUnit); -1 ends
+    int unitCount;
+    int unitCapacity;
+    int liveUnits;
+    long long liveLength;
+
+    int findTerm(const string& term, bool create);
+    void growTermTable();
+    void appendPosting(int term, int unit, const int* positions, int count);
+    void compact();
+    double idf(int term);
+    void termHits(int term, vector<Hit>& hits);
+    void phraseHits(const int* terms, int count, vector<Hit>& hits);
+
+public:
+    PostSearchIndex();
+    ~PostSearchIndex();
+
+    void addText(Post* post, const string& text);
+    void removePost(Post* post);
+    void clear();
+    int search(const string& query, Post** results, int maxResults);
+    int getTermCount() { return termCount; }
+    long long getPostingBytes();
+};
+
+// ==================== HASHTAGS AND MENTIONS ====================
+// Collects the #hashtags (lowercased) and @mentions (as written) in text in
+// one pass, without the marker and without duplicates. A marker counts only
+// at the start of a word, so "C#" and "a@b.com" tag nothing; a tag runs over
+// letters, digits, '_' and UTF-8 bytes, up to MAX_TAG_LENGTH bytes.
+const int MAX_TAG_LENGTH = 64;
+void extractTags(const string& text, vector<string>& hashtags, vector<string>& mentions);
+
+// Posts grouped under string keys (a hashtag, or a mentioned username).
+// Groups live in an open-addressing table. A group's posts are appended as
+// they arrive and sorted by timestamp on the next read if one arrived out of
+// order, as a file load (newest first) does.
+class TagIndex {
+private:
+    struct Timeline {
+        string key;
+        Post** posts;       // Oldest first once sorted; nullptr = free bucket
+        int count;
+        int capacity;
+        bool sorted;
+    };
+
+    Timeline* table;
+    int tableSize;          // Power of two
+    int tableUsed;
+
+    Timeline* find(const string& key, bool create);
+    void grow();
+
+public:
+    TagIndex();
+    ~TagIndex();
+
+    void add(const string& key, Post* post);
+    void remove(const string& key, Post* post);
+    void clear();
+    int get(const string& key, Post** results, int maxResults);   // Newest first
+    int getCount(const string& key);
+    int getKeyCount() { return tableUsed; }
+};
+
+// ==================== TRENDING ====================
+// Heavy hitters of a weighted event stream with exponentially decayed
+// counts, in fixed memory. A Count-Min Sketch (conservative update) holds
+// an upper-bound estimate for every key; a min-heap keeps the K keys with
+// the largest estimates, and a new key takes the place of the smallest
+// when its estimate passes it, as in Space-Saving.
+//
+// Decay is applied forward: an event at time t adds weight * 2^((t - landmark)
+// / halfLife), so stored values never need touching as time passes. Reading
+// scales them back to "now"; all values are rescaled to a new landmark
+// before the factors get large.
+class DecayedTopK {
+public:
+    static const int K = 64;
+    static const int DEPTH = 4;
+    static const int WIDTH = 4096;      // Power of two
+
+    struct Entry {
+        uint64_t key;
+        string label;                   // Hashtag text
+        Post* post;                     // Trending post
+        double count;                   // Scaled to the landmark
+    };
+
+private:
+    double* sketch;                     // DEPTH rows of WIDTH counters
+    Entry heap[K];                      // Min-heap on count
+    int heapSize;
+    double rate;                        // ln 2 / half-life, per second
+    time_t landmark;
+
+    int findEntry(uint64_t key);
+    void siftDown(int index);
+    void siftUp(int index);
+    void rescale(time_t when);
+
+public:
+    DecayedTopK(double halfLifeSeconds);
+    ~DecayedTopK();
+
+    void add(uint64_t key, const string& label, Post* post, double weight, time_t when);
+    void remove(uint64_t key);          // Drops the key from the top-k only
+    // Largest first, with counts decayed to now
+    int top(Entry* out, int maxResults, time_t now);
+    void clear();
+};
+
+// Trending hashtags and posts. Tags score one per post using them; posts
+// score one per like and two per comment. Both decay with a two-hour
+// half-life, so scores read as recent velocity.
+class TrendingTracker {
+private:
+    DecayedTopK tags;
+    DecayedTopK posts;
+
+public:
+    static const int HALF_LIFE_SECONDS = 2 * 3600;
+
+    TrendingTracker() : tags(HALF_LIFE_SECONDS), posts(HALF_LIFE_SECONDS) {}
+
+    void recordTag(const string& tag, double weight, time_t when);
+    void recordPost(Post* post, double weight, time_t when);
+    void forgetPost(Post* post) { posts.remove((uint64_t)post->postID); }
+    // scores may be nullptr
+    int topTags(string* tagsOut, double* scores, int maxResults, time_t now);
+    int topPosts(Post** postsOut, double* scores, int maxResults, time_t now);
+    void clear();
+};
+
+// ==================== POST DATABASE CLASS ====================
+class PostDatabase {
+private:
+    Post* head;
+    Post* tail;
+    int nextPostID;
+    int nextCommentID;
+    int version;    // Bumped whenever posts are added or removed
+    PostSearchIndex searchIndex;
+    TagIndex hashtagIndex;
+    TagIndex mentionIndex;
+    TrendingTracker trending;
+
+    void indexTags(Post* post, time_t when);
+    void unindexTags(Post* post);
+
+public:
+    PostDatabase();
+    ~PostDatabase();
+
+    Post* createPost(int userID, const string& username, const string& content, Timestamp ts);
+    bool deletePost(int postID);
+    Post* findPost(int postID);
+    // Adds the comment and indexes its text; use instead of Post::addComment
+    void addComment(Post* post, int userID, const string& username, const string& text, Timestamp ts);
+    // Likes the post and counts it towards trending; use instead of Post::addLike
+    void addLike(Post* post);
+    // Full-text query (see PostSearchIndex); best match first
+    int searchPosts(const string& query, Post** results, int maxResults);
+    // Posts tagged #tag (given without '#', any case), newest first
+    int getTagPosts(const string& tag, Post** results, int maxResults);
+    // Posts that @mention the username, newest first
+    int getMentions(const string& username, Post** results, int maxResults);
+    // MENTION notifications to the existing users the post mentions, except
+    // its author; returns how many were sent
+    int notifyMentions(Post* post, UserDatabase* users, NotificationQueue* notifications);
+    // Hashtags and posts with the most recent activity, hottest first
+    int getTrendingTags(string* tags, double* scores, int maxResults);
+    int getTrendingPosts(Post** results, double* scores, int maxResults);
+    Post* getHead() { return head; }
+    int getNextCommentID() { return nextCommentID++; }
+    int getVersion() { return version; }
+    void generateDummyPosts(UserDatabase* userDB);
+    void clearAll();
+    
+    // ADD THESE FILE HANDLING METHODS:
+    void saveToFile(const string& filename);
+    void loadFromFile(const string& filename);
+};
+
+// ==================== CHANGE SIGNAL ====================
+// Raised by data mutations (and by the front end for input and timers) so an
+// idle render loop knows it has to draw again. raise() is safe from any
+// thread; when a wake callback is set it is invoked too, so a loop blocked
+// waiting for events returns immediately.
+class ChangeSignal {
+private:
+    static atomic<bool> dirty;
+    static void (*wakeCallback)();
+
+public:
+    static void raise();
+    static bool consume();
+    static void setWakeCallback(void (*callback)());
+};
+
+// ==================== PROFILER ====================
+// Scoped timers around the hot paths (frame phases, feed generation,
+// autosave). Each named zone keeps its last ZONE_SAMPLES durations for
+// rolling percentiles; during a capture every sample is also kept as a
+// Chrome trace event for chrome://tracing or Perfetto. Nothing is recorded
+// until setEnabled(true), so a disabled timer costs one relaxed load.
+// Zone names must be string literals (they are stored by pointer).
+struct ProfileStats {
+    const char* name;
+    int count;          // Samples in the rolling window
+    double p50Ms;
+    double p99Ms;
+    double maxMs;
+};
+
+class Profiler {
+private:
+    static const int MAX_ZONES = 32;
+    static const int ZONE_SAMPLES = 240;
+    static const int MAX_TRACE_EVENTS = 262144;
+
+    struct Zone {
+        const char* name;
+        double samples[ZONE_SAMPLES];   // Milliseconds, ring buffer
+        int next;
+        int count;
+    };
+
+    struct TraceEvent {
+        const char* name;
+        double startUs;
+        double durationUs;
+        int thread;
+    };
+
+    static atomic<bool> enabled;
+    static mutex lock;
+    static Zone zones[MAX_ZONES];
+    static int zoneCount;
+    static TraceEvent* trace;
+    static int traceCount;
+    static int traceDropped;
+    static bool capturing;
+    static chrono::steady_clock::time_point epoch;
+
+public:
+    static bool isEnabled() { return enabled.load(memory_order_relaxed); }
+    static void setEnabled(bool on);
+    static void record(const char* name, chrono::steady_clock::time_point start,
+                       chrono::steady_clock::time_point end);
+    static int getStats(ProfileStats* out, int maxZones);
+    static void reset();
+
+    static void startCapture();
+    static bool isCapturing();
+    static int getCaptureCount();
+    static bool writeTrace(const string& filename);  // Also ends the capture
+};
+
+class ScopedTimer {
+private:
+    const char* name;
+    bool active;
+    chrono::steady_clock::time_point start;
+
+public:
+    ScopedTimer(const char* zoneName) : name(zoneName), active(Profiler::isEnabled()) {
+        if (active) start = chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (active) Profiler::record(name, start, chrono::steady_clock::now());
+    }
+};
+
+// ==================== METRICS ====================
+// Always-on operation counters, size gauges and latency histograms for the
+// databases, feed and notification queue. Recording is a relaxed atomic add,
+// so it is safe from any thread without locks. Every metric links itself
+// into the registry when constructed; Metrics::writePrometheus() dumps them
+// all in Prometheus text format (e.g. for node_exporter's textfile collector).
+enum MetricKind {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+class Metric {
+public:
+    const char* name;
+    const char* help;
+    MetricKind kind;
+    Metric* next;   // Registry list
+
+    Metric(const char* metricName, const char* metricHelp, MetricKind metricKind);
+    virtual ~Metric() {}
+    virtual void writePrometheus(ostream& out) const = 0;
+};
+
+class MetricCounter : public Metric {
+private:
+    atomic<uint64_t> value;
+
+public:
+    MetricCounter(const char* name, const char* help) : Metric(name, help, METRIC_COUNTER), value(0) {}
+
+    void add(uint64_t n = 1) { value.fetch_add(n, memory_order_relaxed); }
+    uint64_t get() const { return value.load(memory_order_relaxed); }
+    void writePrometheus(ostream& out) const override;
+};
+
+class MetricGauge : public Metric {
+private:
+    atomic<int64_t> value;
+
+public:
+    MetricGauge(const char* name, const char* help) : Metric(name, help, METRIC_GAUGE), value(0) {}
+
+    void add(int64_t n) { value.fetch_add(n, memory_order_relaxed); }
+    void set(int64_t n) { value.store(n, memory_order_relaxed); }
+    int64_t get() const { return value.load(memory_order_relaxed); }
+    void writePrometheus(ostream& out) const override;
+};
+
+// Log-linear buckets in the style of HdrHistogram: each power of two from
+// 256 ns to ~69 s is split into SUB_BUCKETS equal steps, so the relative
+// error of any bucket bound is at most 25%. Values are nanoseconds and are
+// exported in seconds.
+class MetricHistogram : public Metric {
+private:
+    static const int SUB_BUCKET_BITS = 2;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MIN_EXPONENT = 8;
+    static const int MAX_EXPONENT = 36;
+    static const int BUCKETS = 1 + (MAX_EXPONENT - MIN_EXPONENT) * SUB_BUCKETS + 1; // Last is +Inf
+
+    atomic<uint64_t> buckets[BUCKETS];
+    atomic<uint64_t> count;
+    atomic<uint64_t> sumNs;
+
+    static int bucketFor(uint64_t ns);
+    static uint64_t upperBound(int bucket);
+
+public:
+    MetricHistogram(const char* name, const char* help);
+
+    void record(uint64_t ns);
+    uint64_t getCount() const { return count.load(memory_order_relaxed); }
+    void writePrometheus(ostream& out) const override;
+};
+
+// Records the lifetime of the enclosing scope into a histogram
+class MetricTimer {
+private:
+    MetricHistogram& histogram;
+    chrono::steady_clock::time_point start;
+
+public:
+    MetricTimer(MetricHistogram& h) : histogram(h), start(chrono::steady_clock::now()) {}
+    ~MetricTimer() {
+        histogram.record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count());
+    }
+};
+
+class Metrics {
+private:
+    static atomic<Metric*> head;
+
+    friend class Metric;
+
+public:
+    // Users
+    static MetricCounter usersRegistered;
+    static MetricCounter logins;
+    static MetricCounter loginFailures;
+    static MetricCounter userLookups;
+    static MetricCounter followChanges;
+    static MetricCounter userSearches;
+    static MetricCounter typeaheadNarrowed;
+    static MetricGauge users;
+    static MetricHistogram registerLatency;
+    static MetricHistogram loginLatency;
+    static MetricHistogram userSearchLatency;
+    static MetricHistogram recommendLatency;
+    static MetricHistogram graphAnalyticsLatency;
+
+    // Posts
+    static MetricCounter postsCreated;
+    static MetricCounter postsDeleted;
+    static MetricCounter postLookups;
+    static MetricCounter likes;
+    static MetricCounter comments;
+    static MetricCounter postSearches;
+    static MetricGauge posts;
+    static MetricHistogram findPostLatency;
+    static MetricHistogram deletePostLatency;
+    static MetricHistogram postSearchLatency;
+
+    // Feed
+    static MetricCounter feedsGenerated;
+    static MetricHistogram generateFeedLatency;
+
+    // Notifications
+    static MetricCounter notificationsAdded;
+    static MetricCounter notificationsEvicted;
+    static MetricCounter notificationsPosted;
+    static MetricCounter notificationRingFull;
+    static MetricCounter notificationsDrained;
+    static MetricCounter inboxReplays;
+    static MetricGauge notifications;
+    static MetricGauge inboxes;
+    static MetricHistogram getNotificationsLatency;
+    static MetricHistogram replayLatency;
+
+    // Persistence
+    static MetricHistogram saveLatency;
+    static MetricHistogram loadLatency;
+
+    static void writePrometheus(ostream& out);
+    static bool writePrometheusFile(const string& filename);
+};
+
+// ==================== UTILITY FUNCTIONS ====================
+Timestamp getCurrentTimestamp();
+string timestampToString(const Timestamp& ts);
+
+// FNV-1a over the bytes of text, for the open-addressing tables keyed by
+// strings. The 64-bit form is for keys that stand in for the string itself.
+inline uint32_t fnv1a(const string& text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a64(const string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+#endif // CORE_H
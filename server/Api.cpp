@@ -0,0 +1,699 @@
+#include "Server.h"
+#include <sys/random.h>
+#include <cerrno>
+
+// ==================== HELPERS ====================
+static HttpResponse errorResponse(int status, const char* message) {
+    JsonWriter json;
+    json.beginObject().key("error").value(message).endObject();
+    return HttpResponse(status, json.str());
+}
+
+// Splits "/api/users/12/follow" into {"api", "users", "12", "follow"}
+static vector<string> splitPath(const string& path) {
+    vector<string> parts;
+    size_t start = 0;
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == string::npos) end = path.size();
+        if (end > start) parts.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+    return parts;
+}
+
+// Positive decimal ID, or -1
+static int parseID(const string& text) {
+    if (text.empty() || text.size() > 9) return -1;
+    int value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value > 0 ? value : -1;
+}
+
+// users.txt and posts.txt hold one field per line, and the JSON parser
+// decodes \n, \t and \u0000, so text fields must not carry control bytes
+static bool hasControlChars(const string& text) {
+    for (unsigned char c : text) {
+        if (c < 0x20 || c == 0x7f) return true;
+    }
+    return false;
+}
+
+static int parseLimit(const HttpRequest& request, int fallback, int maximum) {
+    string text = request.queryParam("limit");
+    if (text.empty()) return fallback;
+    int value = atoi(text.c_str());
+    if (value <= 0) return fallback;
+    return min(value, maximum);
+}
+
+static const char* notificationTypeName(NotificationType type) {
+    switch (type) {
+        case COMMENT: return "comment";
+        case LIKE: return "like";
+        case FOLLOW: return "follow";
+        case MENTION: return "mention";
+        default: return "unknown";
+    }
+}
+
+static void writeUser(JsonWriter& json, User* user) {
+    json.beginObject()
+        .key("id").value(user->userID)
+        .key("username").value(user->username)
+        .key("bio").value(user->bio)
+        .key("followers").value(user->followerCount)
+        .key("following").value(user->followingCount)
+        .key("influence").value((double)user->influence)
+        .endObject();
+}
+
+static void writePost(JsonWriter& json, Post* post, bool withComments) {
+    json.beginObject()
+        .key("id").value(post->postID)
+        .key("userId").value(post->userID)
+        .key("username").value(post->username)
+        .key("content").value(post->content)
+        .key("timestamp").value(timestampToString(post->timestamp))
+        .key("likes").value(post->likes)
+        .key("comments").value(post->commentCount);
+
+    if (withComments) {
+        json.key("commentList").beginArray();
+        for (Comment* c = post->getComments(); c; c = c->next) {
+            json.beginObject()
+                .key("id").value(c->commentID)
+                .key("userId").value(c->userID)
+                .key("username").value(c->username)
+                .key("content").value(c->content)
+                .key("timestamp").value(timestampToString(c->timestamp))
+                .endObject();
+        }
+        json.endArray();
+    }
+    json.endObject();
+}
+
+// ==================== SESSIONS ====================
+// 128 bits from the kernel CSPRNG as hex, or "" if it fails. Anyone who
+// can guess a token is that user, so no seeded generator will do.
+string ApiServer::newToken() {
+    unsigned char bytes[16];
+    size_t filled = 0;
+    while (filled < sizeof(bytes)) {
+        ssize_t got = getrandom(bytes + filled, sizeof(bytes) - filled, 0);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            cerr << "Error: getrandom failed: " << strerror(errno) << endl;
+            return "";
+        }
+        filled += (size_t)got;
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    string token(sizeof(bytes) * 2, '0');
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        token[i * 2] = digits[bytes[i] >> 4];
+        token[i * 2 + 1] = digits[bytes[i] & 15];
+    }
+    return token;
+}
+
+string ApiServer::startSession(User* user) {
+    string token = newToken();
+    if (token.empty()) return token;
+    Session& session = sessions[token];
+    session.userID = user->userID;
+    session.expires = chrono::steady_clock::now() + chrono::seconds(SESSION_IDLE_SECONDS);
+    return token;
+}
+
+User* ApiServer::authenticate(const HttpRequest& request) {
+    const string prefix = "Bearer ";
+    if (request.authorization.compare(0, prefix.size(), prefix) != 0) return nullptr;
+
+    auto it = sessions.find(request.authorization.substr(prefix.size()));
+    if (it == sessions.end()) return nullptr;
+    auto now = chrono::steady_clock::now();
+    if (now >= it->second.expires) {
+        sessions.erase(it);
+        return nullptr;
+    }
+    it->second.expires = now + chrono::seconds(SESSION_IDLE_SECONDS);
+    return users->searchByID(it->second.userID);
+}
+
+void ApiServer::expireSessions() {
+    auto now = chrono::steady_clock::now();
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (now >= it->second.expires) {
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// ==================== ROUTING ====================
+HttpResponse ApiServer::handle(const HttpRequest& request) {
+    ScopedTimer timer("ApiServer::handle");
+    vector<string> parts = splitPath(request.path);
+    const string& method = request.method;
+
+    if (parts.size() == 1 && parts[0] == "health") {
+        if (method != "GET") return errorResponse(405, "method not allowed");
+        return HttpResponse(200, "{\"status\":\"ok\"}");
+    }
+    if (parts.size() == 1 && parts[0] == "metrics") {
+        if (method != "GET") return errorResponse(405, "method not allowed");
+        ostringstream out;
+        Metrics::writePrometheus(out);
+        HttpResponse response(200, out.str());
+        response.contentType = "text/plain; version=0.0.4";
+        return response;
+    }
+    if (parts.size() < 2 || parts[0] != "api") return errorResponse(404, "not found");
+
+    const string& resource = parts[1];
+
+    // /api/register, /api/login, /api/logout, /api/feed, /api/trending,
+    // /api/suggestions
+    if (parts.size() == 2) {
+        if (resource == "register") {
+            if (method != "POST") return errorResponse(405, "method not allowed");
+            return registerUser(request);
+        }
+        if (resource == "login") {
+            if (method != "POST") return errorResponse(405, "method not allowed");
+            return login(request);
+        }
+        if (resource == "logout") {
+            if (method != "POST") return errorResponse(405, "method not allowed");
+            return logout(request);
+        }
+        if (resource == "feed") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getFeed(request);
+        }
+        if (resource == "posts") {
+            if (method != "POST") return errorResponse(405, "method not allowed");
+            return createPost(request);
+        }
+        if (resource == "notifications") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getNotifications(request);
+        }
+        if (resource == "trending") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getTrending(request);
+        }
+        if (resource == "suggestions") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getSuggestions(request);
+        }
+        return errorResponse(404, "not found");
+    }
+
+    // /api/notifications/read-all
+    if (resource == "notifications" && parts.size() == 3 && parts[2] == "read-all") {
+        if (method != "POST") return errorResponse(405, "method not allowed");
+        return markAllRead(request);
+    }
+
+    // /api/users/search?q=text[&prefix=1][&limit=20]
+    if (resource == "users" && parts.size() == 3 && parts[2] == "search") {
+        if (method != "GET") return errorResponse(405, "method not allowed");
+        return searchUsers(request);
+    }
+
+    // /api/posts/search?q=text[&limit=20]
+    if (resource == "posts" && parts.size() == 3 && parts[2] == "search") {
+        if (method != "GET") return errorResponse(405, "method not allowed");
+        return searchPosts(request);
+    }
+
+    // /api/tags/{tag}[?limit=50]
+    if (resource == "tags" && parts.size() == 3) {
+        if (method != "GET") return errorResponse(405, "method not allowed");
+        return getTagPosts(request, urlDecode(parts[2]));
+    }
+
+    int id = parseID(parts[2]);
+    if (id < 0) return errorResponse(404, "not found");
+
+    // /api/users/{id}, /api/users/{id}/posts, /api/users/{id}/mentions,
+    // /api/users/{id}/common, /api/users/{id}/follow
+    if (resource == "users") {
+        if (parts.size() == 3) {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getUser(id);
+        }
+        if (parts.size() == 4 && parts[3] == "posts") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getUserPosts(request, id);
+        }
+        if (parts.size() == 4 && parts[3] == "mentions") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getMentions(request, id);
+        }
+        if (parts.size() == 4 && parts[3] == "common") {
+            if (method != "GET") return errorResponse(405, "method not allowed");
+            return getCommonConnections(request, id);
+        }
+        if (parts.size() == 4 && parts[3] == "follow") {
+            if (method == "POST") return follow(request, id, true);
+            if (method == "DELETE") return follow(request, id, false);
+            return errorResponse(405, "method not allowed");
+        }
+    }
+
+    // /api/posts/{id}, /api/posts/{id}/like, /api/posts/{id}/comments
+    if (resource == "posts") {
+        if (parts.size() == 3) {
+            if (method == "GET") return getPost(id);
+            if (method == "DELETE") return deletePost(request, id);
+            return errorResponse(405, "method not allowed");
+        }
+        if (parts.size() == 4 && parts[3] == "like") {
+            if (method != "POST") return errorResponse(405, "method not allowed");
+            return like(request, id);
+        }
+        if (parts.size() == 4 && parts[3] == "comments") {
+            if (method != "POST") return errorResponse(405, "method not allowed");
+            return comment(request, id);
+        }
+    }
+
+    return errorResponse(404, "not found");
+}
+
+// ==================== ACCOUNTS ====================
+HttpResponse ApiServer::registerUser(const HttpRequest& request) {
+    JsonObject body;
+    if (!body.parse(request.body)) return errorResponse(400, "invalid JSON body");
+
+    string username = body.getString("username");
+    string password = body.getString("password");
+    string bio = body.getString("bio");
+    if (username.length() < 3 || username.length() > 20) {
+        return errorResponse(400, "username must be 3-20 characters");
+    }
+    if (hasControlChars(username) || username.find(' ') != string::npos) {
+        return errorResponse(400, "username cannot contain spaces or control characters");
+    }
+    if (password.length() < 6) {
+        return errorResponse(400, "password must be at least 6 characters");
+    }
+    if (hasControlChars(password) || hasControlChars(bio)) {
+        return errorResponse(400, "password and bio cannot contain control characters");
+    }
+    if (users->searchByUsername(username)) {
+        return errorResponse(409, "username already exists");
+    }
+
+    User* user = users->registerUser(username, password, bio);
+    if (!user) return errorResponse(400, "invalid user");
+
+    // Registering also logs in, as in the UI
+    string token = startSession(user);
+    if (token.empty()) return errorResponse(500, "could not start a session");
+
+    JsonWriter json;
+    json.beginObject().key("token").value(token).key("user");
+    writeUser(json, user);
+    json.endObject();
+    return HttpResponse(201, json.str());
+}
+
+HttpResponse ApiServer::login(const HttpRequest& request) {
+    JsonObject body;
+    if (!body.parse(request.body)) return errorResponse(400, "invalid JSON body");
+
+    User* user = users->login(body.getString("username"), body.getString("password"));
+    if (!user) return errorResponse(401, "invalid username or password");
+
+    string token = startSession(user);
+    if (token.empty()) return errorResponse(500, "could not start a session");
+
+    JsonWriter json;
+    json.beginObject().key("token").value(token).key("user");
+    writeUser(json, user);
+    json.endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::logout(const HttpRequest& request) {
+    if (!authenticate(request)) return errorResponse(401, "not logged in");
+    sessions.erase(request.authorization.substr(strlen("Bearer ")));
+    return HttpResponse(200, "{\"ok\":true}");
+}
+
+// ==================== USERS ====================
+HttpResponse ApiServer::getUser(int userID) {
+    User* user = users->searchByID(userID);
+    if (!user) return errorResponse(404, "user not found");
+
+    JsonWriter json;
+    writeUser(json, user);
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::searchUsers(const HttpRequest& request) {
+    string query = request.queryParam("q");
+    if (query.empty()) return errorResponse(400, "missing q");
+    int limit = parseLimit(request, 20, 100);
+
+    User* found[100];
+    int count = users->searchUsers(query, found, limit, request.queryParam("prefix") == "1");
+
+    JsonWriter json;
+    json.beginObject().key("users").beginArray();
+    for (int i = 0; i < count; i++) {
+        writeUser(json, found[i]);
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::searchPosts(const HttpRequest& request) {
+    string query = request.queryParam("q");
+    if (query.empty()) return errorResponse(400, "missing q");
+    int limit = parseLimit(request, 20, 100);
+
+    Post* found[100];
+    int count = posts->searchPosts(query, found, limit);
+
+    JsonWriter json;
+    json.beginObject().key("posts").beginArray();
+    for (int i = 0; i < count; i++) {
+        writePost(json, found[i], false);
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+// /api/suggestions[?limit=10]: who to follow, by follows in common
+HttpResponse ApiServer::getSuggestions(const HttpRequest& request) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+    int limit = parseLimit(request, 10, 100);
+
+    User* found[100];
+    int connections[100];
+    int count = users->recommendFollows(currentUser, found, connections, limit);
+
+    JsonWriter json;
+    json.beginObject().key("users").beginArray();
+    for (int i = 0; i < count; i++) {
+        json.beginObject().key("followedBy").value(connections[i]).key("user");
+        writeUser(json, found[i]);
+        json.endObject();
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+// Lists the first `limit` IDs of each set as users, with the full counts
+static void writeUserSet(JsonWriter& json, UserDatabase* users, const char* name,
+                         const int* ids, int count, int limit) {
+    json.key(name).beginObject().key("count").value(count).key("users").beginArray();
+    for (int i = 0; i < min(count, limit); i++) {
+        User* user = users->searchByID(ids[i]);
+        if (user) writeUser(json, user);
+    }
+    json.endArray().endObject();
+}
+
+// /api/users/{id}/common[?limit=20]: who the logged-in user has in common
+// with this one
+HttpResponse ApiServer::getCommonConnections(const HttpRequest& request, int userID) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+    User* target = users->searchByID(userID);
+    if (!target) return errorResponse(404, "user not found");
+    int limit = parseLimit(request, 20, 100);
+
+    int followedByIDs[100], mutualIDs[100];
+    int followedBy = target->getFollowedByFollowing(currentUser, followedByIDs, limit);
+    int mutual = target->getMutualFollowers(currentUser, mutualIDs, limit);
+
+    JsonWriter json;
+    json.beginObject();
+    writeUserSet(json, users, "followedBy", followedByIDs, followedBy, limit);
+    writeUserSet(json, users, "mutualFollowers", mutualIDs, mutual, limit);
+    json.endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::getUserPosts(const HttpRequest& request, int userID) {
+    if (!users->searchByID(userID)) return errorResponse(404, "user not found");
+    int limit = parseLimit(request, 50, 500);
+
+    // Posts are kept newest first
+    JsonWriter json;
+    json.beginObject().key("posts").beginArray();
+    int written = 0;
+    for (Post* post = posts->getHead(); post && written < limit; post = post->next) {
+        if (post->userID != userID) continue;
+        writePost(json, post, false);
+        written++;
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::getMentions(const HttpRequest& request, int userID) {
+    User* user = users->searchByID(userID);
+    if (!user) return errorResponse(404, "user not found");
+    int limit = parseLimit(request, 50, 500);
+
+    Post* found[500];
+    int count = posts->getMentions(user->username, found, limit);
+
+    JsonWriter json;
+    json.beginObject().key("posts").beginArray();
+    for (int i = 0; i < count; i++) {
+        writePost(json, found[i], false);
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::getTagPosts(const HttpRequest& request, const string& tag) {
+    int limit = parseLimit(request, 50, 500);
+
+    Post* found[500];
+    int count = posts->getTagPosts(tag, found, limit);
+
+    JsonWriter json;
+    json.beginObject().key("tag").value(tag).key("posts").beginArray();
+    for (int i = 0; i < count; i++) {
+        writePost(json, found[i], false);
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+// /api/trending[?limit=10]; scores are decayed activity counts
+HttpResponse ApiServer::getTrending(const HttpRequest& request) {
+    int limit = parseLimit(request, 10, DecayedTopK::K);
+
+    string tags[DecayedTopK::K];
+    Post* found[DecayedTopK::K];
+    double tagScores[DecayedTopK::K], postScores[DecayedTopK::K];
+    int tagCount = posts->getTrendingTags(tags, tagScores, limit);
+    int postCount = posts->getTrendingPosts(found, postScores, limit);
+
+    JsonWriter json;
+    json.beginObject().key("tags").beginArray();
+    for (int i = 0; i < tagCount; i++) {
+        json.beginObject().key("tag").value(tags[i]).key("score").value(tagScores[i]).endObject();
+    }
+    json.endArray().key("posts").beginArray();
+    for (int i = 0; i < postCount; i++) {
+        json.beginObject().key("score").value(postScores[i]).key("post");
+        writePost(json, found[i], false);
+        json.endObject();
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::follow(const HttpRequest& request, int userID, bool start) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    User* target = users->searchByID(userID);
+    if (!target) return errorResponse(404, "user not found");
+    if (target == currentUser) return errorResponse(400, "cannot follow yourself");
+
+    if (start && !currentUser->isFollowing(userID)) {
+        currentUser->addFollowing(userID);
+        target->addFollower(currentUser->userID);
+        notifications->addNotification(userID, FOLLOW, currentUser->userID,
+                                       currentUser->username, 0,
+                                       currentUser->username + " followed you",
+                                       getCurrentTimestamp());
+    } else if (!start && currentUser->isFollowing(userID)) {
+        currentUser->removeFollowing(userID);
+        target->removeFollower(currentUser->userID);
+    }
+
+    JsonWriter json;
+    json.beginObject().key("following").value(start).endObject();
+    return HttpResponse(200, json.str());
+}
+
+// ==================== POSTS ====================
+HttpResponse ApiServer::createPost(const HttpRequest& request) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    JsonObject body;
+    if (!body.parse(request.body)) return errorResponse(400, "invalid JSON body");
+
+    string content = body.getString("content");
+    if (content.empty()) return errorResponse(400, "post cannot be empty");
+    if (content.length() > 280) return errorResponse(400, "post is too long (max 280 characters)");
+    if (hasControlChars(content)) return errorResponse(400, "post cannot contain control characters");
+
+    Post* post = posts->createPost(currentUser->userID, currentUser->username, content,
+                                   getCurrentTimestamp());
+    if (!post) return errorResponse(400, "invalid post");
+    posts->notifyMentions(post, users, notifications);
+
+    JsonWriter json;
+    writePost(json, post, false);
+    return HttpResponse(201, json.str());
+}
+
+HttpResponse ApiServer::getPost(int postID) {
+    Post* post = posts->findPost(postID);
+    if (!post) return errorResponse(404, "post not found");
+
+    JsonWriter json;
+    writePost(json, post, true);
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::deletePost(const HttpRequest& request, int postID) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    Post* post = posts->findPost(postID);
+    if (!post) return errorResponse(404, "post not found");
+    if (post->userID != currentUser->userID) return errorResponse(403, "not your post");
+
+    posts->deletePost(postID);
+    return HttpResponse(200, "{\"ok\":true}");
+}
+
+HttpResponse ApiServer::like(const HttpRequest& request, int postID) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    Post* post = posts->findPost(postID);
+    if (!post) return errorResponse(404, "post not found");
+    if (post->userID == currentUser->userID) return errorResponse(403, "cannot like your own post");
+
+    posts->addLike(post);
+    notifications->addNotification(post->userID, LIKE, currentUser->userID,
+                                   currentUser->username, post->postID,
+                                   currentUser->username + " liked your post",
+                                   getCurrentTimestamp());
+
+    JsonWriter json;
+    json.beginObject().key("likes").value(post->likes).endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::comment(const HttpRequest& request, int postID) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    Post* post = posts->findPost(postID);
+    if (!post) return errorResponse(404, "post not found");
+
+    JsonObject body;
+    if (!body.parse(request.body)) return errorResponse(400, "invalid JSON body");
+
+    // Same bound as the UI's comment box
+    string text = body.getString("content");
+    if (text.empty()) return errorResponse(400, "comment cannot be empty");
+    if (text.length() > 511) return errorResponse(400, "comment is too long (max 511 characters)");
+    if (hasControlChars(text)) return errorResponse(400, "comment cannot contain control characters");
+
+    posts->addComment(post, currentUser->userID, currentUser->username, text, getCurrentTimestamp());
+    notifications->addNotification(post->userID, COMMENT, currentUser->userID,
+                                   currentUser->username, post->postID,
+                                   currentUser->username + " commented on your post",
+                                   getCurrentTimestamp());
+
+    JsonWriter json;
+    json.beginObject().key("comments").value(post->commentCount).endObject();
+    return HttpResponse(201, json.str());
+}
+
+// ==================== FEED ====================
+HttpResponse ApiServer::getFeed(const HttpRequest& request) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+    int limit = parseLimit(request, 50, 500);
+
+    // ?mode=ranked orders by score instead of time
+    feed.setRanked(request.queryParam("mode") == "ranked");
+    feed.generateFeed(currentUser, posts);
+
+    JsonWriter json;
+    json.beginObject().key("count").value(feed.getCount()).key("posts").beginArray();
+    int shown = min(limit, feed.getCount());
+    for (int i = 0; i < shown; i++) {
+        writePost(json, feed.getPost(i), false);
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+// ==================== NOTIFICATIONS ====================
+HttpResponse ApiServer::getNotifications(const HttpRequest& request) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    // All of them unless a smaller limit is asked for
+    int inboxLimit = notifications->getInboxLimit();
+    int limit = parseLimit(request, inboxLimit, inboxLimit);
+    vector<Notification*> notifArr(limit);
+    int count = 0;
+    notifications->getAllNotifications(currentUser->userID, notifArr.data(), count, limit);
+
+    JsonWriter json;
+    json.beginObject()
+        .key("unread").value(notifications->getUnreadCount(currentUser->userID))
+        .key("notifications").beginArray();
+    for (int i = 0; i < count; i++) {
+        Notification* n = notifArr[i];
+        json.beginObject()
+            .key("id").value(n->notificationID)
+            .key("type").value(notificationTypeName(n->type))
+            .key("fromUserId").value(n->fromUserID)
+            .key("fromUsername").value(n->fromUsername)
+            .key("postId").value(n->postID)
+            .key("message").value(n->message)
+            .key("timestamp").value(timestampToString(n->timestamp))
+            .key("read").value(n->isRead)
+            .endObject();
+    }
+    json.endArray().endObject();
+    return HttpResponse(200, json.str());
+}
+
+HttpResponse ApiServer::markAllRead(const HttpRequest& request) {
+    User* currentUser = authenticate(request);
+    if (!currentUser) return errorResponse(401, "not logged in");
+
+    notifications->markAllRead(currentUser->userID);
+    return HttpResponse(200, "{\"ok\":true}");
+}
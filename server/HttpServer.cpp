@@ -0,0 +1,372 @@
+#include "Server.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+// ==================== HTTP REQUEST ====================
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+string urlDecode(const string& text) {
+    string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '+') {
+            out += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() &&
+                   hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            out += (char)(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+string HttpRequest::queryParam(const string& name) const {
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == string::npos) end = query.size();
+        size_t eq = query.find('=', start);
+        if (eq != string::npos && eq < end && query.compare(start, eq - start, name) == 0 &&
+            eq - start == name.size()) {
+            return urlDecode(query.substr(eq + 1, end - eq - 1));
+        }
+        start = end + 1;
+    }
+    return "";
+}
+
+const char* httpStatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
+
+// ==================== HTTP SERVER ====================
+HttpServer::HttpServer()
+    : listenFd(-1), epollFd(-1), tickMs(1000), stopFlag(nullptr), openConnections(0) {}
+
+HttpServer::~HttpServer() {
+    for (size_t i = 0; i < connections.size(); i++) {
+        if (connections[i]) closeConnection(connections[i]);
+    }
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool HttpServer::listen(const string& host, int port) {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        cerr << "Error: socket() failed: " << strerror(errno) << endl;
+        return false;
+    }
+
+    int on = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        cerr << "Error: Invalid listen address " << host << endl;
+        return false;
+    }
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listenFd, SOMAXCONN) < 0) {
+        cerr << "Error: Could not listen on " << host << ":" << port << ": " << strerror(errno) << endl;
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        cerr << "Error: epoll_create1() failed: " << strerror(errno) << endl;
+        return false;
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    return true;
+}
+
+void HttpServer::run(volatile bool* stop) {
+    stopFlag = stop;
+    epoll_event events[MAX_EVENTS];
+    auto lastTick = chrono::steady_clock::now();
+
+    while (!*stopFlag) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, tickMs);
+        if (ready < 0 && errno != EINTR) {
+            cerr << "Error: epoll_wait() failed: " << strerror(errno) << endl;
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+
+            HttpConnection* conn = (size_t)fd < connections.size() ? connections[fd] : nullptr;
+            if (!conn) continue;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(conn);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                handleWritable(conn);
+                if (!connections[fd]) continue; // Closed while writing
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                handleReadable(conn); // Also notices the peer's close
+            }
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (tick && now - lastTick >= chrono::milliseconds(tickMs)) {
+            tick();
+            lastTick = now;
+        }
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                cerr << "Warning: accept4() failed: " << strerror(errno) << endl;
+            }
+            return;
+        }
+
+        // Responses are written in one go; don't hold them back for Nagle
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        if ((size_t)fd >= connections.size()) {
+            connections.resize(fd + 1, nullptr);
+        }
+        HttpConnection* conn = new HttpConnection(fd);
+        connections[fd] = conn;
+        openConnections++;
+
+        conn->events = EPOLLIN | EPOLLRDHUP;
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = conn->events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void HttpServer::handleReadable(HttpConnection* conn) {
+    char buffer[64 * 1024];
+    bool peerClosed = false;
+
+    while (true) {
+        ssize_t n = recv(conn->fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            conn->input.append(buffer, (size_t)n);
+            if ((size_t)n < sizeof(buffer)) break;
+        } else if (n == 0) {
+            peerClosed = true;
+            break;
+        } else {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+            break;
+        }
+    }
+
+    if (!parseRequests(conn) || peerClosed) {
+        // Send whatever was answered, then close
+        conn->closeAfterWrite = true;
+    }
+    if (!flushOutput(conn)) return;
+    if (conn->closeAfterWrite && conn->outputOffset == conn->output.size()) {
+        closeConnection(conn);
+    }
+}
+
+void HttpServer::handleWritable(HttpConnection* conn) {
+    if (!flushOutput(conn)) return;
+    if (conn->closeAfterWrite && conn->outputOffset == conn->output.size()) {
+        closeConnection(conn);
+    }
+}
+
+// Parses and answers every complete request in the input buffer (clients
+// may pipeline). Returns false when the connection must be closed.
+bool HttpServer::parseRequests(HttpConnection* conn) {
+    size_t consumed = 0;
+    bool keepGoing = true;
+
+    while (keepGoing) {
+        size_t headerEnd = conn->input.find("\r\n\r\n", consumed);
+        if (headerEnd == string::npos) {
+            if (conn->input.size() - consumed > MAX_HEADER_BYTES) {
+                queueResponse(conn, HttpResponse(431, "{\"error\":\"headers too large\"}"), false);
+                return false;
+            }
+            break;
+        }
+
+        HttpRequest request;
+        request.keepAlive = true;
+        size_t lineEnd = conn->input.find("\r\n", consumed);
+        string requestLine = conn->input.substr(consumed, lineEnd - consumed);
+
+        size_t sp1 = requestLine.find(' ');
+        size_t sp2 = sp1 == string::npos ? string::npos : requestLine.find(' ', sp1 + 1);
+        if (sp2 == string::npos) {
+            queueResponse(conn, HttpResponse(400, "{\"error\":\"malformed request line\"}"), false);
+            return false;
+        }
+        request.method = requestLine.substr(0, sp1);
+        string target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+        request.version = requestLine.substr(sp2 + 1);
+        size_t q = target.find('?');
+        request.path = target.substr(0, q);
+        if (q != string::npos) request.query = target.substr(q + 1);
+        if (request.version == "HTTP/1.0") request.keepAlive = false;
+
+        // Headers
+        size_t contentLength = 0;
+        size_t pos = lineEnd + 2;
+        while (pos < headerEnd) {
+            size_t end = conn->input.find("\r\n", pos);
+            size_t colon = conn->input.find(':', pos);
+            if (colon != string::npos && colon < end) {
+                string name = conn->input.substr(pos, colon - pos);
+                size_t valueStart = conn->input.find_first_not_of(" \t", colon + 1);
+                string value = valueStart < end ? conn->input.substr(valueStart, end - valueStart) : "";
+                transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+                if (name == "content-length") {
+                    contentLength = (size_t)strtoull(value.c_str(), nullptr, 10);
+                } else if (name == "authorization") {
+                    request.authorization = value;
+                } else if (name == "connection") {
+                    transform(value.begin(), value.end(), value.begin(), ::tolower);
+                    if (value == "close") request.keepAlive = false;
+                    if (value == "keep-alive") request.keepAlive = true;
+                } else if (name == "transfer-encoding") {
+                    queueResponse(conn, HttpResponse(501, "{\"error\":\"chunked bodies are not supported\"}"), false);
+                    return false;
+                }
+            }
+            pos = end + 2;
+        }
+
+        if (contentLength > MAX_BODY_BYTES) {
+            queueResponse(conn, HttpResponse(413, "{\"error\":\"body too large\"}"), false);
+            return false;
+        }
+        size_t bodyStart = headerEnd + 4;
+        if (conn->input.size() - bodyStart < contentLength) break; // Wait for the rest
+
+        request.body = conn->input.substr(bodyStart, contentLength);
+        consumed = bodyStart + contentLength;
+
+        HttpResponse response;
+        if (handler) {
+            response = handler(request);
+        } else {
+            response = HttpResponse(503, "{\"error\":\"no handler\"}");
+        }
+        queueResponse(conn, response, request.keepAlive);
+        keepGoing = request.keepAlive;
+    }
+
+    conn->input.erase(0, consumed);
+    return keepGoing;
+}
+
+void HttpServer::queueResponse(HttpConnection* conn, const HttpResponse& response, bool keepAlive) {
+    char header[256];
+    snprintf(header, sizeof(header),
+             "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+             response.status, httpStatusText(response.status), response.contentType.c_str(),
+             response.body.size(), keepAlive ? "keep-alive" : "close");
+    conn->output += header;
+    conn->output += response.body;
+    if (!keepAlive) conn->closeAfterWrite = true;
+}
+
+// Returns false if the connection was closed
+bool HttpServer::flushOutput(HttpConnection* conn) {
+    while (conn->outputOffset < conn->output.size()) {
+        ssize_t n = send(conn->fd, conn->output.data() + conn->outputOffset,
+                         conn->output.size() - conn->outputOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->outputOffset += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateInterest(conn, true); // Socket buffer full; resume on EPOLLOUT
+            return true;
+        } else {
+            closeConnection(conn);
+            return false;
+        }
+    }
+
+    conn->output.clear();
+    conn->outputOffset = 0;
+    updateInterest(conn, false);
+    return true;
+}
+
+void HttpServer::updateInterest(HttpConnection* conn, bool wantWrite) {
+    // A closing connection only waits to drain its output; reading from a
+    // half-closed peer would otherwise report readiness forever
+    uint32_t events = 0;
+    if (!conn->closeAfterWrite) events |= EPOLLIN | EPOLLRDHUP;
+    if (wantWrite) events |= EPOLLOUT;
+    if (conn->events == events) return;
+    conn->events = events;
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = conn->fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+void HttpServer::closeConnection(HttpConnection* conn) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    connections[conn->fd] = nullptr;
+    openConnections--;
+    delete conn;
+}
@@ -0,0 +1,257 @@
+#include "Server.h"
+#include <cmath>
+
+// ==================== JSON OBJECT ====================
+static void skipSpace(const string& text, size_t& i) {
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n' || text[i] == '\r')) i++;
+}
+
+static void appendUtf8(string& out, unsigned code) {
+    if (code < 0x80) {
+        out += (char)code;
+    } else if (code < 0x800) {
+        out += (char)(0xC0 | (code >> 6));
+        out += (char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += (char)(0xE0 | (code >> 12));
+        out += (char)(0x80 | ((code >> 6) & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    } else {
+        out += (char)(0xF0 | (code >> 18));
+        out += (char)(0x80 | ((code >> 12) & 0x3F));
+        out += (char)(0x80 | ((code >> 6) & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+}
+
+static bool parseHex4(const string& text, size_t i, unsigned& code) {
+    if (i + 4 > text.size()) return false;
+    code = 0;
+    for (size_t k = i; k < i + 4; k++) {
+        char c = text[k];
+        code <<= 4;
+        if (c >= '0' && c <= '9') code |= c - '0';
+        else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+// Parses a string starting at the opening quote; i ends past the closing one
+static bool parseString(const string& text, size_t& i, string& out) {
+    if (i >= text.size() || text[i] != '"') return false;
+    i++;
+    out.clear();
+    while (i < text.size()) {
+        char c = text[i++];
+        if (c == '"') return true;
+        if ((unsigned char)c < 0x20) return false;
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (i >= text.size()) return false;
+        char e = text[i++];
+        switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned code;
+                if (!parseHex4(text, i, code)) return false;
+                i += 4;
+                // Surrogate pair
+                if (code >= 0xD800 && code <= 0xDBFF && i + 6 <= text.size() &&
+                    text[i] == '\\' && text[i + 1] == 'u') {
+                    unsigned low;
+                    if (parseHex4(text, i + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default: return false;
+        }
+    }
+    return false;
+}
+
+bool JsonObject::parse(const string& text) {
+    fields.clear();
+    size_t i = 0;
+    skipSpace(text, i);
+    if (i >= text.size() || text[i] != '{') return false;
+    i++;
+    skipSpace(text, i);
+    if (i < text.size() && text[i] == '}') {
+        i++;
+        skipSpace(text, i);
+        return i == text.size();
+    }
+
+    while (true) {
+        string name, value;
+        skipSpace(text, i);
+        if (!parseString(text, i, name)) return false;
+        skipSpace(text, i);
+        if (i >= text.size() || text[i] != ':') return false;
+        i++;
+        skipSpace(text, i);
+        if (i >= text.size()) return false;
+
+        if (text[i] == '"') {
+            if (!parseString(text, i, value)) return false;
+        } else {
+            // Number or literal; nested objects and arrays are not accepted
+            size_t start = i;
+            while (i < text.size() && text[i] != ',' && text[i] != '}' &&
+                   text[i] != ' ' && text[i] != '\t' && text[i] != '\n' && text[i] != '\r') {
+                if (text[i] == '{' || text[i] == '[' || text[i] == '"') return false;
+                i++;
+            }
+            value = text.substr(start, i - start);
+            if (value.empty()) return false;
+        }
+        fields.push_back(make_pair(name, value));
+
+        skipSpace(text, i);
+        if (i >= text.size()) return false;
+        if (text[i] == ',') {
+            i++;
+            continue;
+        }
+        if (text[i] != '}') return false;
+        i++;
+        skipSpace(text, i);
+        return i == text.size();
+    }
+}
+
+bool JsonObject::has(const string& key) const {
+    for (const auto& field : fields) {
+        if (field.first == key) return true;
+    }
+    return false;
+}
+
+string JsonObject::getString(const string& key, const string& fallback) const {
+    for (const auto& field : fields) {
+        if (field.first == key) return field.second;
+    }
+    return fallback;
+}
+
+long long JsonObject::getInt(const string& key, long long fallback) const {
+    for (const auto& field : fields) {
+        if (field.first != key) continue;
+        char* end;
+        long long value = strtoll(field.second.c_str(), &end, 10);
+        return (end != field.second.c_str() && *end == '\0') ? value : fallback;
+    }
+    return fallback;
+}
+
+// ==================== JSON WRITER ====================
+void jsonEscape(string& out, const string& text) {
+    out += '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (first.empty()) return;
+    if (!first.back()) out += ',';
+    first.back() = false;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separator();
+    out += '{';
+    first.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out += '}';
+    first.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separator();
+    out += '[';
+    first.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out += ']';
+    first.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separator();
+    jsonEscape(out, name);
+    out += ':';
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const string& text) {
+    separator();
+    jsonEscape(out, text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    return value(string(text));
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separator();
+    out += to_string(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separator();
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.6g", isfinite(number) ? number : 0.0);
+    out += buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separator();
+    out += flag ? "true" : "false";
+    return *this;
+}
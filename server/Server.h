@@ -0,0 +1,187 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+// Headless HTTP/JSON front end for the core library. Linux only (epoll).
+// One thread runs the event loop and every handler, so the core data
+// structures are never touched concurrently and need no locking.
+
+// ==================== CORE ====================
+#include "../include/Core.h"
+
+// ==================== STANDARD LIBRARIES ====================
+#include <unordered_map>
+#include <functional>
+
+// ==================== HTTP ====================
+struct HttpRequest {
+    string method;
+    string path;        // Without the query string
+    string query;       // Text after '?', undecoded
+    string version;
+    string authorization;
+    string body;
+    bool keepAlive;
+
+    string queryParam(const string& name) const;
+};
+
+struct HttpResponse {
+    int status;
+    string contentType;
+    string body;
+
+    HttpResponse() : status(200), contentType("application/json") {}
+    HttpResponse(int code, const string& json) : status(code), contentType("application/json"), body(json) {}
+};
+
+class HttpConnection {
+public:
+    int fd;
+    string input;           // Bytes received but not yet parsed
+    string output;          // Serialized responses not yet sent
+    size_t outputOffset;
+    bool closeAfterWrite;
+    uint32_t events;        // epoll mask currently registered
+
+    HttpConnection(int socket)
+        : fd(socket), outputOffset(0), closeAfterWrite(false), events(0) {}
+};
+
+class HttpServer {
+public:
+    typedef function<HttpResponse(const HttpRequest&)> Handler;
+
+private:
+    static const size_t MAX_HEADER_BYTES = 16 * 1024;
+    static const size_t MAX_BODY_BYTES = 1024 * 1024;
+    static const int MAX_EVENTS = 256;
+
+    int listenFd;
+    int epollFd;
+    Handler handler;
+    function<void()> tick;
+    int tickMs;
+    volatile bool* stopFlag;
+
+    // Indexed by file descriptor; descriptors are small and dense
+    vector<HttpConnection*> connections;
+    int openConnections;
+
+    void acceptConnections();
+    void handleReadable(HttpConnection* conn);
+    void handleWritable(HttpConnection* conn);
+    bool parseRequests(HttpConnection* conn);
+    void queueResponse(HttpConnection* conn, const HttpResponse& response, bool keepAlive);
+    bool flushOutput(HttpConnection* conn);
+    void updateInterest(HttpConnection* conn, bool wantWrite);
+    void closeConnection(HttpConnection* conn);
+
+public:
+    HttpServer();
+    ~HttpServer();
+
+    bool listen(const string& host, int port);
+    void setHandler(Handler h) { handler = h; }
+    void setTick(function<void()> callback, int intervalMs) { tick = callback; tickMs = intervalMs; }
+    void run(volatile bool* stop);
+    int getOpenConnections() { return openConnections; }
+};
+
+const char* httpStatusText(int status);
+string urlDecode(const string& text);   // %XX escapes and '+'
+
+// ==================== JSON ====================
+// Request bodies are flat objects of strings, numbers, booleans and nulls;
+// values are kept as decoded strings (numbers and literals as written).
+class JsonObject {
+private:
+    vector<pair<string, string>> fields;
+
+public:
+    bool parse(const string& text);
+    bool has(const string& key) const;
+    string getString(const string& key, const string& fallback = "") const;
+    long long getInt(const string& key, long long fallback = 0) const;
+};
+
+class JsonWriter {
+private:
+    string out;
+    vector<bool> first;     // Per open container: no element written yet
+    bool afterKey;          // Next value belongs to the key just written
+
+    void separator();
+
+public:
+    JsonWriter() : afterKey(false) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const char* name);
+    JsonWriter& value(const string& text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(long long number);
+    JsonWriter& value(int number) { return value((long long)number); }
+    JsonWriter& value(bool flag);
+    JsonWriter& value(double number);   // Finite; up to 6 significant digits
+    const string& str() const { return out; }
+};
+
+void jsonEscape(string& out, const string& text);
+
+// ==================== API ====================
+struct Session {
+    int userID;
+    chrono::steady_clock::time_point expires;
+};
+
+class ApiServer {
+public:
+    static const int SESSION_IDLE_SECONDS = 24 * 60 * 60;  // Unused this long, a token stops working
+
+private:
+    UserDatabase* users;
+    PostDatabase* posts;
+    NotificationQueue* notifications;
+    Feed feed;
+
+    unordered_map<string, Session> sessions;    // Bearer token -> user
+
+    User* authenticate(const HttpRequest& request);
+    string newToken();
+    string startSession(User* user);
+
+    HttpResponse registerUser(const HttpRequest& request);
+    HttpResponse login(const HttpRequest& request);
+    HttpResponse logout(const HttpRequest& request);
+    HttpResponse getUser(int userID);
+    HttpResponse searchUsers(const HttpRequest& request);
+    HttpResponse getSuggestions(const HttpRequest& request);
+    HttpResponse searchPosts(const HttpRequest& request);
+    HttpResponse getUserPosts(const HttpRequest& request, int userID);
+    HttpResponse getMentions(const HttpRequest& request, int userID);
+    HttpResponse getCommonConnections(const HttpRequest& request, int userID);
+    HttpResponse getTagPosts(const HttpRequest& request, const string& tag);
+    HttpResponse getTrending(const HttpRequest& request);
+    HttpResponse follow(const HttpRequest& request, int userID, bool start);
+    HttpResponse createPost(const HttpRequest& request);
+    HttpResponse getPost(int postID);
+    HttpResponse deletePost(const HttpRequest& request, int postID);
+    HttpResponse like(const HttpRequest& request, int postID);
+    HttpResponse comment(const HttpRequest& request, int postID);
+    HttpResponse getFeed(const HttpRequest& request);
+    HttpResponse getNotifications(const HttpRequest& request);
+    HttpResponse markAllRead(const HttpRequest& request);
+
+public:
+    ApiServer(UserDatabase* u, PostDatabase* p, NotificationQueue* n)
+        : users(u), posts(p), notifications(n) {}
+
+    HttpResponse handle(const HttpRequest& request);
+    // Forgets sessions idle past SESSION_IDLE_SECONDS
+    void expireSessions();
+};
+
+#endif // SERVER_H
@@ -0,0 +1,151 @@
+#include "Server.h"
+#include <csignal>
+
+// ==================== SIGNALS ====================
+static volatile bool stopRequested = false;
+
+static void onSignal(int) {
+    stopRequested = true;
+}
+
+static void printUsage(const char* program) {
+    cout << "Usage: " << program << " [--host ADDR] [--port N] [--data DIR]\n"
+         << "  --host ADDR   IPv4 address to listen on (default 127.0.0.1)\n"
+         << "  --port N      TCP port (default 8080)\n"
+         << "  --data DIR    Directory holding users.txt, connections.txt, posts.txt\n"
+         << "                and notifications.dat (default: current directory)\n";
+}
+
+// ==================== MAIN ====================
+int main(int argc, char** argv) {
+    string host = "127.0.0.1";
+    int port = 8080;
+    string dataDir = ".";
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            host = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--data" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Error: Unknown option " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (port <= 0 || port > 65535) {
+        cerr << "Error: Invalid port " << port << endl;
+        return 1;
+    }
+
+    string usersFile = dataDir + "/users.txt";
+    string connectionsFile = dataDir + "/connections.txt";
+    string postsFile = dataDir + "/posts.txt";
+
+    // Notifications each user keeps in memory; older ones stay in the segment
+    const int INBOX_LIMIT = 500;
+
+    UserDatabase userDB;
+    PostDatabase postDB;
+    NotificationQueue notifQueue(INBOX_LIMIT);
+
+    cout << "Loading data from " << dataDir << "..." << endl;
+    userDB.loadFromFile(usersFile);
+    userDB.loadConnectionsFromFile(connectionsFile);
+    postDB.loadFromFile(postsFile);
+    notifQueue.openSegment(dataDir + "/notifications.dat");
+    cout << "Loaded " << userDB.getUserCount() << " users" << endl;
+
+    GraphAnalyticsReport report;
+    if (userDB.runGraphAnalytics(0, &report)) {
+        cout << "Graph analytics: " << report.components << " components, "
+             << report.iterations << " PageRank iterations in " << report.seconds * 1000.0 << " ms" << endl;
+    }
+
+    ApiServer api(&userDB, &postDB, &notifQueue);
+    HttpServer server;
+    if (!server.listen(host, port)) return 1;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    server.setHandler([&](const HttpRequest& request) { return api.handle(request); });
+
+    // Housekeeping runs on the event loop thread between batches of requests
+    const int AUTOSAVE_INTERVAL_SECONDS = 30;
+    const int METRICS_INTERVAL_SECONDS = 10;
+    const int ANALYTICS_INTERVAL_SECONDS = 600;
+    auto lastSaveTime = chrono::steady_clock::now();
+    auto lastMetricsTime = lastSaveTime;
+    auto lastAnalyticsTime = lastSaveTime;
+    // Periodic analytics: the snapshot is taken and the results published
+    // here, the computation in between runs on analyticsThread
+    GraphAnalytics* analytics = nullptr;
+    thread analyticsThread;
+    atomic<bool> analyticsDone(false);
+    string metricsFile = dataDir + "/metrics.prom";
+    Metrics::writePrometheusFile(metricsFile);
+
+    server.setTick([&]() {
+        notifQueue.drainPending();
+
+        auto now = chrono::steady_clock::now();
+        if (now - lastSaveTime >= chrono::seconds(AUTOSAVE_INTERVAL_SECONDS)) {
+            ScopedTimer timer("autosave");
+            userDB.saveToFile(usersFile);
+            userDB.saveConnectionsToFile(connectionsFile);
+            postDB.saveToFile(postsFile);
+            api.expireSessions();
+            lastSaveTime = now;
+        }
+        // Influence drifts as people follow and unfollow
+        if (analytics && analyticsDone.load()) {
+            analyticsThread.join();
+            GraphAnalyticsReport report;
+            userDB.publishGraphAnalytics(analytics, &report);
+            delete analytics;
+            analytics = nullptr;
+            cout << "Graph analytics: " << report.components << " components, "
+                 << report.iterations << " PageRank iterations in " << report.seconds * 1000.0 << " ms" << endl;
+        } else if (!analytics && now - lastAnalyticsTime >= chrono::seconds(ANALYTICS_INTERVAL_SECONDS)) {
+            analytics = new GraphAnalytics();
+            if (analytics->snapshot(&userDB, 0)) {
+                analyticsDone = false;
+                analyticsThread = thread([&]() {
+                    analytics->compute();
+                    analyticsDone = true;
+                });
+            } else {
+                delete analytics;
+                analytics = nullptr;
+            }
+            lastAnalyticsTime = now;
+        }
+        if (now - lastMetricsTime >= chrono::seconds(METRICS_INTERVAL_SECONDS)) {
+            Metrics::writePrometheusFile(metricsFile);
+            lastMetricsTime = now;
+        }
+    }, 100);
+
+    cout << "Listening on http://" << host << ":" << port << endl;
+    server.run(&stopRequested);
+
+    cout << "Shutting down, saving data..." << endl;
+    if (analytics) {
+        analyticsThread.join();
+        delete analytics;
+    }
+    notifQueue.drainPending();
+    userDB.saveToFile(usersFile);
+    userDB.saveConnectionsToFile(connectionsFile);
+    postDB.saveToFile(postsFile);
+    Metrics::writePrometheusFile(metricsFile);
+    return 0;
+}
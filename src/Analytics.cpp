@@ -0,0 +1,309 @@
+#include "../include/Core.h"
+#include <cmath>
+
+// ==================== WORKERS ====================
+// One PageRank iteration over nodes [begin, end): each node pulls the shares
+// its followers published last iteration and publishes its own for the
+// next. A node that follows nobody publishes nothing; its rank is returned
+// in dangling and spread over everyone through the next base. Shares are
+// floats so the array the gathers hit randomly is half the size; the sums
+// and ranks stay double.
+static void rankRange(const long long* inOffsets, const int* inSources, const int* outDegree,
+                      const float* share, double base, double* rank, float* nextShare,
+                      int begin, int end, double* residual, double* dangling) {
+    double change = 0.0;
+    double lost = 0.0;
+    for (int v = begin; v < end; v++) {
+        double sum = 0.0;
+        for (long long e = inOffsets[v]; e < inOffsets[v + 1]; e++) {
+            sum += share[inSources[e]];
+        }
+        double value = base + GraphAnalytics::DAMPING * sum;
+        change += fabs(value - rank[v]);
+        rank[v] = value;
+        if (outDegree[v] > 0) {
+            nextShare[v] = (float)(value / outDegree[v]);
+        } else {
+            nextShare[v] = 0.0f;
+            lost += value;
+        }
+    }
+    *residual = change;
+    *dangling = lost;
+}
+
+// Labels only ever decrease, and always name a node of the same component
+static inline bool lowerLabel(atomic<int>& label, int value) {
+    int current = label.load(memory_order_relaxed);
+    while (value < current) {
+        if (label.compare_exchange_weak(current, value, memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+// Every edge whose ends disagree pulls both ends, and the node named by the
+// higher label, down to the lower label
+static void hookRange(const long long* inOffsets, const int* inSources, atomic<int>* labels,
+                      int begin, int end, bool* changed) {
+    bool any = false;
+    for (int v = begin; v < end; v++) {
+        for (long long e = inOffsets[v]; e < inOffsets[v + 1]; e++) {
+            int u = inSources[e];
+            int labelU = labels[u].load(memory_order_relaxed);
+            int labelV = labels[v].load(memory_order_relaxed);
+            if (labelU == labelV) continue;
+            int low = min(labelU, labelV);
+            lowerLabel(labels[max(labelU, labelV)], low);
+            lowerLabel(labels[u], low);
+            lowerLabel(labels[v], low);
+            any = true;
+        }
+    }
+    *changed = any;
+}
+
+// Point each node straight at the end of its label chain
+static void compressRange(atomic<int>* labels, int begin, int end) {
+    for (int v = begin; v < end; v++) {
+        int label = labels[v].load(memory_order_relaxed);
+        while (true) {
+            int next = labels[label].load(memory_order_relaxed);
+            if (next == label) break;
+            label = next;
+        }
+        labels[v].store(label, memory_order_relaxed);
+    }
+}
+
+// ==================== GRAPH ANALYTICS ====================
+GraphAnalytics::GraphAnalytics()
+    : nodeCount(0), edgeCount(0), nodes(nullptr), inOffsets(nullptr), inSources(nullptr),
+      outDegree(nullptr), rank(nullptr), component(nullptr), workers(1), iterations(0), residual(0.0) {
+    bounds[0] = bounds[1] = 0;
+}
+
+GraphAnalytics::~GraphAnalytics() {
+    release();
+}
+
+void GraphAnalytics::release() {
+    delete[] nodes;
+    delete[] inOffsets;
+    delete[] inSources;
+    delete[] outDegree;
+    delete[] rank;
+    delete[] component;
+    nodes = nullptr;
+    inOffsets = nullptr;
+    inSources = nullptr;
+    outDegree = nullptr;
+    rank = nullptr;
+    component = nullptr;
+    nodeCount = 0;
+    edgeCount = 0;
+}
+
+void GraphAnalytics::buildSnapshot(UserDatabase* users) {
+    release();
+    int capacity = users->getUserCount();
+    if (capacity <= 0) return;
+    nodes = new User*[capacity];
+    users->getAllUsers(nodes, nodeCount);
+    if (nodeCount == 0) return;
+
+    // IDs are handed out in order, so they're dense unless users were lost
+    // on load; then a node is found by binary search instead
+    int firstID = nodes[0]->userID;
+    bool dense = nodes[nodeCount - 1]->userID - firstID == nodeCount - 1;
+    int* ids = nullptr;
+    if (!dense) {
+        ids = new int[nodeCount];
+        for (int v = 0; v < nodeCount; v++) ids[v] = nodes[v]->userID;
+    }
+    int count = nodeCount;
+    auto nodeOf = [dense, firstID, ids, count](int id) {
+        if (dense) {
+            int node = id - firstID;
+            return (unsigned)node < (unsigned)count ? node : -1;
+        }
+        const int* found = lower_bound(ids, ids + count, id);
+        return (found != ids + count && *found == id) ? (int)(found - ids) : -1;
+    };
+
+    // Followers that aren't loaded users are dropped, so count first
+    inOffsets = new long long[nodeCount + 1];
+    inOffsets[0] = 0;
+    for (int v = 0; v < nodeCount; v++) {
+        const User* user = nodes[v];
+        int valid = 0;
+        for (int i = 0; i < user->followerCount; i++) {
+            if (nodeOf(user->followersList[i]) >= 0) valid++;
+        }
+        inOffsets[v + 1] = inOffsets[v] + valid;
+    }
+    edgeCount = inOffsets[nodeCount];
+
+    // followersList is sorted, so each node's sources are too
+    inSources = new int[edgeCount];
+    outDegree = new int[nodeCount]();
+    for (int v = 0; v < nodeCount; v++) {
+        const User* user = nodes[v];
+        long long e = inOffsets[v];
+        for (int i = 0; i < user->followerCount; i++) {
+            int u = nodeOf(user->followersList[i]);
+            if (u < 0) continue;
+            inSources[e++] = u;
+            outDegree[u]++;
+        }
+    }
+    delete[] ids;
+
+    rank = new double[nodeCount];
+    component = new int[nodeCount];
+}
+
+void GraphAnalytics::splitWork(int threads) {
+    if (threads <= 0) threads = (int)max(thread::hardware_concurrency(), 1u);
+    workers = min(threads, (int)MAX_WORKERS);
+    if (edgeCount + nodeCount < PARALLEL_WORK) workers = 1;
+    workers = max(min(workers, nodeCount), 1);
+
+    // Contiguous runs of nodes costing about the same: one per node plus
+    // one per in-edge
+    long long total = edgeCount + nodeCount;
+    bounds[0] = 0;
+    int v = 0;
+    for (int w = 1; w < workers; w++) {
+        long long target = total * w / workers;
+        while (v < nodeCount && inOffsets[v] + v < target) v++;
+        bounds[w] = v;
+    }
+    bounds[workers] = nodeCount;
+}
+
+int GraphAnalytics::computePageRank(double& residual) {
+    float* share = new float[nodeCount];
+    float* nextShare = new float[nodeCount];
+    double dangling = 0.0;
+    for (int v = 0; v < nodeCount; v++) {
+        rank[v] = 1.0 / nodeCount;
+        share[v] = outDegree[v] > 0 ? (float)(rank[v] / outDegree[v]) : 0.0f;
+        if (outDegree[v] == 0) dangling += rank[v];
+    }
+
+    double partialResidual[MAX_WORKERS];
+    double partialDangling[MAX_WORKERS];
+    int iterations = 0;
+    residual = 0.0;
+    while (iterations < MAX_ITERATIONS) {
+        double base = ((1.0 - DAMPING) + DAMPING * dangling) / nodeCount;
+
+        thread pool[MAX_WORKERS];
+        for (int w = 1; w < workers; w++) {
+            pool[w] = thread(rankRange, inOffsets, inSources, outDegree, share, base, rank, nextShare,
+                             bounds[w], bounds[w + 1], &partialResidual[w], &partialDangling[w]);
+        }
+        rankRange(inOffsets, inSources, outDegree, share, base, rank, nextShare,
+                  bounds[0], bounds[1], &partialResidual[0], &partialDangling[0]);
+        for (int w = 1; w < workers; w++) pool[w].join();
+
+        residual = 0.0;
+        dangling = 0.0;
+        for (int w = 0; w < workers; w++) {
+            residual += partialResidual[w];
+            dangling += partialDangling[w];
+        }
+        swap(share, nextShare);
+        iterations++;
+        if (residual < TOLERANCE) break;
+    }
+
+    delete[] share;
+    delete[] nextShare;
+    return iterations;
+}
+
+void GraphAnalytics::computeComponents() {
+    // Follows count in either direction. Once a pass changes nothing every
+    // edge joins equal labels, and each component is labelled with its
+    // smallest node.
+    atomic<int>* labels = new atomic<int>[nodeCount];
+    for (int v = 0; v < nodeCount; v++) labels[v].store(v, memory_order_relaxed);
+
+    bool changed[MAX_WORKERS];
+    bool any = true;
+    while (any) {
+        thread pool[MAX_WORKERS];
+        for (int w = 1; w < workers; w++) {
+            pool[w] = thread(hookRange, inOffsets, inSources, labels, bounds[w], bounds[w + 1], &changed[w]);
+        }
+        hookRange(inOffsets, inSources, labels, bounds[0], bounds[1], &changed[0]);
+        for (int w = 1; w < workers; w++) pool[w].join();
+
+        for (int w = 1; w < workers; w++) {
+            pool[w] = thread(compressRange, labels, bounds[w], bounds[w + 1]);
+        }
+        compressRange(labels, bounds[0], bounds[1]);
+        for (int w = 1; w < workers; w++) pool[w].join();
+
+        any = false;
+        for (int w = 0; w < workers; w++) any = any || changed[w];
+    }
+
+    for (int v = 0; v < nodeCount; v++) component[v] = labels[v].load(memory_order_relaxed);
+    delete[] labels;
+}
+
+bool GraphAnalytics::snapshot(UserDatabase* users, int threads) {
+    started = chrono::steady_clock::now();
+    buildSnapshot(users);
+    if (nodeCount == 0) {
+        release();
+        return false;
+    }
+    splitWork(threads);
+    return true;
+}
+
+void GraphAnalytics::compute() {
+    iterations = computePageRank(residual);
+    computeComponents();
+}
+
+void GraphAnalytics::publish(GraphAnalyticsReport* report) {
+    // Write back: influence 1.0 is an average user
+    int* sizes = new int[nodeCount]();
+    int components = 0;
+    int largest = 0;
+    for (int v = 0; v < nodeCount; v++) {
+        User* user = nodes[v];
+        int root = component[v];
+        user->influence = (float)(rank[v] * nodeCount);
+        user->componentID = nodes[root]->userID;
+        if (sizes[root]++ == 0) components++;
+        largest = max(largest, sizes[root]);
+    }
+    delete[] sizes;
+
+    if (report) {
+        report->users = nodeCount;
+        report->edges = edgeCount;
+        report->iterations = iterations;
+        report->residual = residual;
+        report->components = components;
+        report->largestComponent = largest;
+        report->seconds = elapsedSeconds();
+    }
+    release();
+}
+
+bool GraphAnalytics::run(UserDatabase* users, int threads, GraphAnalyticsReport* report) {
+    if (!snapshot(users, threads)) return false;
+    compute();
+    publish(report);
+    return true;
+}
+
+double GraphAnalytics::elapsedSeconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now() - started).count();
+}
@@ -0,0 +1,24 @@
+#include "../include/Core.h"
+
+// ==================== CHANGE SIGNAL ====================
+atomic<bool> ChangeSignal::dirty(true);
+void (*ChangeSignal::wakeCallback)() = nullptr;
+
+void ChangeSignal::raise() {
+    // Plain load first so busy producers only share the cache line for
+    // reading while the flag is already set
+    if (dirty.load()) return;
+    
+    // Only the first raise after a consume() needs to wake the loop
+    if (!dirty.exchange(true) && wakeCallback) {
+        wakeCallback();
+    }
+}
+
+bool ChangeSignal::consume() {
+    return dirty.exchange(false);
+}
+
+void ChangeSignal::setWakeCallback(void (*callback)()) {
+    wakeCallback = callback;
+}
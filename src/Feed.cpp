@@ -1,10 +1,68 @@
-#include "App.h"
+#include "Core.h"
+
+// ==================== RANKING ====================
+// Freshness halves over the first few hours: 1 / (1 + age / FRESHNESS_HOURS)^2
+static const float FRESHNESS_HOURS = 6.0f;
+// Engagement saturates: popularity runs from 1 to 1 + POPULARITY_BOOST and is
+// halfway there at ENGAGEMENT_HALF likes (a comment counts as two)
+static const float POPULARITY_BOOST = 4.0f;
+static const float ENGAGEMENT_HALF = 20.0f;
+// Authors who follow back
+static const float MUTUAL_AFFINITY = 1.5f;
+
+// Seconds since 1970-01-01 of a wall-clock time, without time zones (days
+// from civil date). Only differences are used, so DST shifts don't matter
+// and this is far cheaper than mktime().
+static long long civilSeconds(const Timestamp& ts) {
+    int y = ts.year - (ts.month <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (ts.month + (ts.month > 2 ? -3 : 9)) + 2) / 5 + ts.day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long long days = (long long)era * 146097 + dayOfEra - 719468;
+    return days * 86400 + ts.hour * 3600 + ts.minute * 60 + ts.second;
+}
+
+// No branches or calls, non-aliased arrays and a trip count in whole blocks:
+// GCC vectorizes this at -O2, where it won't add alias checks or a scalar
+// tail loop. n must be a multiple of SCORE_BLOCK.
+static const int SCORE_BLOCK = 8;
+static_assert(Feed::MAX_CANDIDATES % SCORE_BLOCK == 0, "padding must fit the candidate buffers");
+
+static void scoreCandidates(int n, const float* __restrict age, const float* __restrict likes,
+                            const float* __restrict comments, const float* __restrict affinity,
+                            float* __restrict score) {
+    for (int i = 0; i < n; i += SCORE_BLOCK) {
+        for (int j = i; j < i + SCORE_BLOCK; j++) {
+            float decay = 1.0f + age[j] * (1.0f / FRESHNESS_HOURS);
+            float engagement = likes[j] + 2.0f * comments[j];
+            float popularity = 1.0f + POPULARITY_BOOST * engagement / (engagement + ENGAGEMENT_HALF);
+            score[j] = affinity[j] * popularity / (decay * decay);
+        }
+    }
+}
 
 // ==================== FEED CLASS ====================
-Feed::Feed() : head(nullptr), count(0) {}
+Feed::Feed()
+    : head(nullptr), tail(nullptr), count(0), ranked(false), indexCapacity(32),
+      candidates(nullptr), candidateAge(nullptr), candidateLikes(nullptr),
+      candidateComments(nullptr), candidateAffinity(nullptr), candidateScore(nullptr),
+      candidateOrder(nullptr), followKeys(nullptr), followAffinity(nullptr), followTableSize(0) {
+    index = new Post*[indexCapacity];
+}
 
 Feed::~Feed() {
     clear();
+    delete[] index;
+    delete[] candidates;
+    delete[] candidateAge;
+    delete[] candidateLikes;
+    delete[] candidateComments;
+    delete[] candidateAffinity;
+    delete[] candidateScore;
+    delete[] candidateOrder;
+    delete[] followKeys;
+    delete[] followAffinity;
 }
 
 void Feed::clear() {
@@ -14,7 +72,7 @@ void Feed::clear() {
         current = current->next;
         delete temp;
     }
-    head = nullptr;
+    head = tail = nullptr;
     count = 0;
 }
 
@@ -25,6 +83,7 @@ void Feed::insertSorted(Post* post) {
     if (!head || post->timestamp.isNewer(head->post->timestamp)) {
         newNode->next = head;
         head = newNode;
+        if (!tail) tail = newNode;
     } else {
         // Find insertion point
         FeedNode* current = head;
@@ -33,23 +92,156 @@ void Feed::insertSorted(Post* post) {
         }
         newNode->next = current->next;
         current->next = newNode;
+        if (current == tail) tail = newNode;
     }
     
     count++;
 }
 
+void Feed::append(Post* post) {
+    FeedNode* newNode = new FeedNode(post);
+    if (tail) {
+        tail->next = newNode;
+    } else {
+        head = newNode;
+    }
+    tail = newNode;
+    count++;
+}
+
 void Feed::generateFeed(User* currentUser, PostDatabase* allPosts) {
+    ScopedTimer timer("Feed::generateFeed");
+    MetricTimer latency(Metrics::generateFeedLatency);
+    Metrics::feedsGenerated.add();
     clear();
     
     if (!currentUser) return;
     
+    if (ranked) {
+        generateRankedFeed(currentUser, allPosts);
+        rebuildIndex();
+        return;
+    }
+    
     // Collect posts from followed users
     Post* current = allPosts->getHead();
-    while (current && count < 20) {
+    while (current && count < FEED_SIZE) {
         // Include posts from users we follow
         if (currentUser->isFollowing(current->userID)) {
             insertSorted(current);
         }
         current = current->next;
     }
-}
\ No newline at end of file
+    
+    rebuildIndex();
+}
+
+void Feed::rebuildIndex() {
+    if (count > indexCapacity) {
+        while (indexCapacity < count) indexCapacity *= 2;
+        delete[] index;
+        index = new Post*[indexCapacity];
+    }
+    
+    int i = 0;
+    for (FeedNode* node = head; node; node = node->next) {
+        index[i++] = node->post;
+    }
+}
+
+// ==================== RANKED FEED ====================
+void Feed::buildFollowTable(User* currentUser) {
+    // At most half full; kept between calls and only ever grown
+    int needed = 16;
+    while (needed < currentUser->followingCount * 2) needed *= 2;
+    if (needed > followTableSize) {
+        delete[] followKeys;
+        delete[] followAffinity;
+        followTableSize = needed;
+        followKeys = new int[followTableSize];
+        followAffinity = new float[followTableSize];
+    }
+    memset(followKeys, 0, followTableSize * sizeof(int));
+    
+    int mask = followTableSize - 1;
+    for (int i = 0; i < currentUser->followingCount; i++) {
+        int id = currentUser->followingList[i];
+        int slot = (int)(((uint32_t)id * 2654435761u) & (uint32_t)mask);
+        while (followKeys[slot] != 0 && followKeys[slot] != id) slot = (slot + 1) & mask;
+        followKeys[slot] = id;
+        followAffinity[slot] = 1.0f;
+    }
+    
+    // Followed authors who follow back
+    for (int i = 0; i < currentUser->followerCount; i++) {
+        int id = currentUser->followersList[i];
+        int slot = (int)(((uint32_t)id * 2654435761u) & (uint32_t)mask);
+        while (followKeys[slot] != 0) {
+            if (followKeys[slot] == id) {
+                followAffinity[slot] = MUTUAL_AFFINITY;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+}
+
+float Feed::lookupAffinity(int authorID) {
+    int mask = followTableSize - 1;
+    int slot = (int)(((uint32_t)authorID * 2654435761u) & (uint32_t)mask);
+    while (followKeys[slot] != 0) {
+        if (followKeys[slot] == authorID) return followAffinity[slot];
+        slot = (slot + 1) & mask;
+    }
+    return 0.0f;
+}
+
+void Feed::generateRankedFeed(User* currentUser, PostDatabase* allPosts) {
+    if (currentUser->followingCount == 0) return;
+    
+    if (!candidates) {
+        candidates = new Post*[MAX_CANDIDATES];
+        candidateAge = new float[MAX_CANDIDATES];
+        candidateLikes = new float[MAX_CANDIDATES];
+        candidateComments = new float[MAX_CANDIDATES];
+        candidateAffinity = new float[MAX_CANDIDATES];
+        candidateScore = new float[MAX_CANDIDATES];
+        candidateOrder = new int[MAX_CANDIDATES];
+    }
+    buildFollowTable(currentUser);
+    
+    // Gather: the newest posts by followed users
+    long long now = civilSeconds(getCurrentTimestamp());
+    int n = 0;
+    for (Post* current = allPosts->getHead(); current && n < MAX_CANDIDATES; current = current->next) {
+        float affinity = lookupAffinity(current->userID);
+        if (affinity == 0.0f) continue;
+        candidates[n] = current;
+        // Clamped here so a clock skewed into the future can't inflate a score
+        long long age = max(now - civilSeconds(current->timestamp), 0LL);
+        candidateAge[n] = (float)age * (1.0f / 3600.0f);
+        candidateLikes[n] = (float)current->likes;
+        candidateComments[n] = (float)current->commentCount;
+        candidateAffinity[n] = affinity;
+        n++;
+    }
+    
+    // Pad to a whole block; the padding is scored but never selected
+    int padded = (n + SCORE_BLOCK - 1) / SCORE_BLOCK * SCORE_BLOCK;
+    for (int i = n; i < padded; i++) {
+        candidateAge[i] = candidateLikes[i] = candidateComments[i] = candidateAffinity[i] = 0.0f;
+    }
+    scoreCandidates(padded, candidateAge, candidateLikes, candidateComments, candidateAffinity, candidateScore);
+    
+    // Select the best FEED_SIZE without sorting the rest
+    int shown = min(n, (int)FEED_SIZE);
+    for (int i = 0; i < n; i++) candidateOrder[i] = i;
+    const float* score = candidateScore;
+    partial_sort(candidateOrder, candidateOrder + shown, candidateOrder + n, [score](int a, int b) {
+        if (score[a] != score[b]) return score[a] > score[b];
+        return a < b; // Newer first on ties
+    });
+    for (int i = 0; i < shown; i++) {
+        append(candidates[candidateOrder[i]]);
+    }
+}
@@ -1,4 +1,4 @@
-#include "App.h"
+#include "Core.h"
 
 // ==================== HISTORY CLASS ====================
 History::History() : top(nullptr), count(0) {}
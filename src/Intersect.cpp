@@ -0,0 +1,96 @@
+#include "../include/Core.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define INTERSECT_SSE2 1
+#endif
+
+// ==================== SORTED ID INTERSECTION ====================
+// Gallop once the longer list is this many times the shorter: below it a
+// merge reads both lists faster than the searches skip
+static const int GALLOP_RATIO = 32;
+
+static inline void emit(int value, int* out, int maxOut, int& found) {
+    if (found < maxOut) out[found] = value;
+    found++;
+}
+
+// Plain merge of a[i..) and b[j..)
+static int mergeFrom(const int* a, int aCount, const int* b, int bCount, int i, int j,
+                     int* out, int maxOut, int found) {
+    while (i < aCount && j < bCount) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            emit(a[i], out, maxOut, found);
+            i++;
+            j++;
+        }
+    }
+    return found;
+}
+
+int intersectSortedScalar(const int* a, int aCount, const int* b, int bCount, int* out, int maxOut) {
+    return mergeFrom(a, aCount, b, bCount, 0, 0, out, maxOut, 0);
+}
+
+// Each ID of small is searched for in large, starting where the last one
+// was found
+static int gallop(const int* small, int smallCount, const int* large, int largeCount, int* out, int maxOut) {
+    int found = 0;
+    int low = 0;
+    for (int i = 0; i < smallCount && low < largeCount; i++) {
+        int target = small[i];
+        low = gallopSearch(large, largeCount, low, target);
+        if (low == largeCount) break;
+        if (large[low] == target) {
+            emit(target, out, maxOut, found);
+            low++;
+        }
+    }
+    return found;
+}
+
+#ifdef INTERSECT_SSE2
+// Four IDs of a against four of b: compare a's block with b's and its three
+// rotations, so one mask says which of a's four appear among b's four. The
+// block with the smaller last ID is used up and replaced (both on a tie).
+// No pair of blocks is compared twice, and b has no duplicates, so each
+// common ID is reported exactly once and in order.
+static int mergeSSE2(const int* a, int aCount, const int* b, int bCount, int* out, int maxOut) {
+    int found = 0;
+    int i = 0, j = 0;
+    while (i + 4 <= aCount && j + 4 <= bCount) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i hits = _mm_cmpeq_epi32(va, vb);
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(hits));
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            emit(a[i + lane], out, maxOut, found);
+            mask &= mask - 1;
+        }
+
+        int aLast = a[i + 3], bLast = b[j + 3];
+        if (aLast <= bLast) i += 4;
+        if (bLast <= aLast) j += 4;
+    }
+    return mergeFrom(a, aCount, b, bCount, i, j, out, maxOut, found);
+}
+#endif
+
+int intersectSorted(const int* a, int aCount, const int* b, int bCount, int* out, int maxOut) {
+    if (aCount <= 0 || bCount <= 0) return 0;
+    if ((long long)aCount * GALLOP_RATIO < bCount) return gallop(a, aCount, b, bCount, out, maxOut);
+    if ((long long)bCount * GALLOP_RATIO < aCount) return gallop(b, bCount, a, aCount, out, maxOut);
+#ifdef INTERSECT_SSE2
+    return mergeSSE2(a, aCount, b, bCount, out, maxOut);
+#else
+    return mergeFrom(a, aCount, b, bCount, 0, 0, out, maxOut, 0);
+#endif
+}
@@ -1,5 +1,17 @@
 #include "App.h"
 
+// Any input or window event means the UI has to be redrawn. These are
+// installed before the ImGui backend, which chains to them.
+static void onCursorPos(GLFWwindow*, double, double) { ChangeSignal::raise(); }
+static void onCursorEnter(GLFWwindow*, int) { ChangeSignal::raise(); }
+static void onMouseButton(GLFWwindow*, int, int, int) { ChangeSignal::raise(); }
+static void onScroll(GLFWwindow*, double, double) { ChangeSignal::raise(); }
+static void onKey(GLFWwindow*, int, int, int, int) { ChangeSignal::raise(); }
+static void onChar(GLFWwindow*, unsigned int) { ChangeSignal::raise(); }
+static void onWindowFocus(GLFWwindow*, int) { ChangeSignal::raise(); }
+static void onFramebufferSize(GLFWwindow*, int, int) { ChangeSignal::raise(); }
+static void onWindowRefresh(GLFWwindow*) { ChangeSignal::raise(); }
+
 int main() {
     // Initialize GLFW
     if (!glfwInit()) {
@@ -23,6 +35,19 @@ int main() {
     glfwMakeContextCurrent(window);
     glfwSwapInterval(1); // Enable vsync
 
+    glfwSetCursorPosCallback(window, onCursorPos);
+    glfwSetCursorEnterCallback(window, onCursorEnter);
+    glfwSetMouseButtonCallback(window, onMouseButton);
+    glfwSetScrollCallback(window, onScroll);
+    glfwSetKeyCallback(window, onKey);
+    glfwSetCharCallback(window, onChar);
+    glfwSetWindowFocusCallback(window, onWindowFocus);
+    glfwSetFramebufferSizeCallback(window, onFramebufferSize);
+    glfwSetWindowRefreshCallback(window, onWindowRefresh);
+
+    // Changes raised from background threads wake the blocked main loop
+    ChangeSignal::setWakeCallback(glfwPostEmptyEvent);
+
     // Initialize ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -48,9 +73,13 @@ int main() {
     userDB.loadConnectionsFromFile("connections.txt");
     postDB.loadFromFile("posts.txt");
     
+    // Notifications are replayed per user on first view, not here
+    notifQueue.openSegment("notifications.dat");
+    
     // If no data exists, generate dummy data
     User* testUser = userDB.searchByUsername("alice");
-    if (!testUser) {
+    bool freshData = !testUser;
+    if (freshData) {
         cout << "No existing data found. Generating dummy data..." << endl;
         userDB.generateDummyUsers();
         postDB.generateDummyPosts(&userDB);
@@ -61,11 +90,15 @@ int main() {
         postDB.saveToFile("posts.txt");
     }
     
+    // Influence and components for search and suggestions; before the UI
+    // starts its typeahead worker, so nothing else reads users meanwhile
+    userDB.runGraphAnalytics(0, nullptr);
+    
     UI ui(&userDB, &postDB, &notifQueue, &history);
     
-    // Initialize notifications for alice if exists
-    User* alice = userDB.searchByUsername("alice");
-    if (alice) {
+    // Seed alice's notifications only alongside freshly generated data;
+    // otherwise they come from notifications.dat
+    if (freshData) {
         ui.initializeDummyData(); // This only adds notifications
     }
 
@@ -73,14 +106,40 @@ int main() {
     auto lastSaveTime = std::chrono::steady_clock::now();
     const int AUTOSAVE_INTERVAL_SECONDS = 30; // Save every 30 seconds
 
+    // Metrics snapshot for external monitoring (Prometheus textfile format)
+    auto lastMetricsTime = std::chrono::steady_clock::now();
+    const int METRICS_INTERVAL_SECONDS = 10;
+    Metrics::writePrometheusFile("metrics.prom");
+
+    // Idle handling: after the last input or data change a few more frames
+    // are drawn so ImGui can settle hover/active state, then the loop sleeps
+    // in glfwWaitEventsTimeout until an event, a ChangeSignal wake-up, or
+    // the next timer (autosave, minute tick for relative timestamps).
+    const int SETTLE_FRAMES = 3;
+    const double CARET_BLINK_SECONDS = 0.5;
+    int framesToDraw = SETTLE_FRAMES;
+    long long lastMinute = (long long)time(0) / 60;
+
     // Main loop
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        if (framesToDraw > 0) {
+            glfwPollEvents();
+        } else {
+            auto sinceSave = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastSaveTime).count();
+            auto sinceMetrics = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastMetricsTime).count();
+            double timeout = std::min(AUTOSAVE_INTERVAL_SECONDS - sinceSave, 60.0 - (double)(time(0) % 60));
+            timeout = std::min(timeout, METRICS_INTERVAL_SECONDS - sinceMetrics);
+            if (ImGui::GetIO().WantTextInput) {
+                timeout = std::min(timeout, CARET_BLINK_SECONDS);
+            }
+            glfwWaitEventsTimeout(std::max(timeout, 0.0));
+        }
 
         // Auto-save periodically
         auto currentTime = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(currentTime - lastSaveTime).count();
         if (elapsed >= AUTOSAVE_INTERVAL_SECONDS) {
+            ScopedTimer timer("autosave");
             cout << "Auto-saving data..." << endl;
             userDB.saveToFile("users.txt");
             userDB.saveConnectionsToFile("connections.txt");
@@ -88,24 +147,70 @@ int main() {
             lastSaveTime = currentTime;
         }
 
+        // Export metrics periodically; this does not need a redraw
+        if (currentTime - lastMetricsTime >= std::chrono::seconds(METRICS_INTERVAL_SECONDS)) {
+            Metrics::writePrometheusFile("metrics.prom");
+            lastMetricsTime = currentTime;
+        }
+
+        // Relative timestamps ("3m ago") change when the minute ticks
+        long long minute = (long long)time(0) / 60;
+        if (minute != lastMinute) {
+            lastMinute = minute;
+            ChangeSignal::raise();
+        }
+
+        // Consume before draining so a producer that posts during the drain
+        // re-raises the flag instead of being absorbed by this frame
+        bool changed = ChangeSignal::consume();
+
+        // Move notifications posted by background producers into the inboxes
+        {
+            ScopedTimer timer("drainPending");
+            notifQueue.drainPending();
+        }
+
+        if (changed) {
+            framesToDraw = SETTLE_FRAMES;
+        } else if (framesToDraw == 0 && ImGui::GetIO().WantTextInput) {
+            framesToDraw = 1; // Keep the text caret blinking
+        }
+        if (framesToDraw == 0) {
+            continue; // Nothing changed: skip the frame entirely
+        }
+        framesToDraw--;
+        ScopedTimer frameTimer("frame");
+
         // Start ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
         // Render UI
-        ui.render();
+        {
+            ScopedTimer timer("UI::render");
+            ui.render();
+        }
 
         // Rendering
-        ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-        glfwSwapBuffers(window);
+        {
+            ScopedTimer timer("ImGui::Render");
+            ImGui::Render();
+        }
+        {
+            ScopedTimer timer("RenderDrawData");
+            int display_w, display_h;
+            glfwGetFramebufferSize(window, &display_w, &display_h);
+            glViewport(0, 0, display_w, display_h);
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+
+        {
+            ScopedTimer timer("SwapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
 
     // Final save before exit
@@ -113,6 +218,7 @@ int main() {
     userDB.saveToFile("users.txt");
     userDB.saveConnectionsToFile("connections.txt");
     postDB.saveToFile("posts.txt");
+    Metrics::writePrometheusFile("metrics.prom");
 
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
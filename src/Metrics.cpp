@@ -0,0 +1,175 @@
+#include "../include/Core.h"
+#include <cstdio>
+
+// ==================== METRIC REGISTRY ====================
+atomic<Metric*> Metrics::head(nullptr);
+
+Metric::Metric(const char* metricName, const char* metricHelp, MetricKind metricKind)
+    : name(metricName), help(metricHelp), kind(metricKind), next(nullptr) {
+    // Lock-free push; metrics are normally all static, but this keeps late
+    // registration from another thread safe too
+    Metric* first = Metrics::head.load(memory_order_relaxed);
+    do {
+        next = first;
+    } while (!Metrics::head.compare_exchange_weak(first, this, memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+static void writeHeader(ostream& out, const Metric& metric, const char* type) {
+    out << "# HELP " << metric.name << " " << metric.help << "\n";
+    out << "# TYPE " << metric.name << " " << type << "\n";
+}
+
+void MetricCounter::writePrometheus(ostream& out) const {
+    writeHeader(out, *this, "counter");
+    out << name << " " << get() << "\n";
+}
+
+void MetricGauge::writePrometheus(ostream& out) const {
+    writeHeader(out, *this, "gauge");
+    out << name << " " << get() << "\n";
+}
+
+// ==================== HISTOGRAM ====================
+MetricHistogram::MetricHistogram(const char* name, const char* help)
+    : Metric(name, help, METRIC_HISTOGRAM), count(0), sumNs(0) {
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i].store(0, memory_order_relaxed);
+    }
+}
+
+// Bucket 0 holds values up to 2^MIN_EXPONENT. After that, bucket bounds are
+// 2^e + j * 2^(e - SUB_BUCKET_BITS) for j = 1..SUB_BUCKETS.
+int MetricHistogram::bucketFor(uint64_t ns) {
+    if (ns <= (1ull << MIN_EXPONENT)) return 0;
+    uint64_t v = ns - 1;
+    int exponent = 63 - __builtin_clzll(v);
+    if (exponent >= MAX_EXPONENT) return BUCKETS - 1;
+    int sub = (int)((v >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return 1 + (exponent - MIN_EXPONENT) * SUB_BUCKETS + sub;
+}
+
+uint64_t MetricHistogram::upperBound(int bucket) {
+    if (bucket == 0) return 1ull << MIN_EXPONENT;
+    int exponent = MIN_EXPONENT + (bucket - 1) / SUB_BUCKETS;
+    int sub = (bucket - 1) % SUB_BUCKETS + 1;
+    return (1ull << exponent) + ((uint64_t)sub << (exponent - SUB_BUCKET_BITS));
+}
+
+void MetricHistogram::record(uint64_t ns) {
+    buckets[bucketFor(ns)].fetch_add(1, memory_order_relaxed);
+    count.fetch_add(1, memory_order_relaxed);
+    sumNs.fetch_add(ns, memory_order_relaxed);
+}
+
+void MetricHistogram::writePrometheus(ostream& out) const {
+    writeHeader(out, *this, "histogram");
+
+    // Bucket counts are read one by one while writers may be active; the
+    // +Inf bucket is taken from the running total so it is never smaller
+    // than the finite buckets before it
+    char buffer[128];
+    uint64_t cumulative = 0;
+    for (int i = 0; i < BUCKETS - 1; i++) {
+        cumulative += buckets[i].load(memory_order_relaxed);
+        snprintf(buffer, sizeof(buffer), "%s_bucket{le=\"%.9g\"} %llu\n",
+                 name, upperBound(i) / 1e9, (unsigned long long)cumulative);
+        out << buffer;
+    }
+    cumulative += buckets[BUCKETS - 1].load(memory_order_relaxed);
+    uint64_t total = max(cumulative, getCount());
+
+    snprintf(buffer, sizeof(buffer), "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)total);
+    out << buffer;
+    snprintf(buffer, sizeof(buffer), "%s_sum %.9f\n", name, sumNs.load(memory_order_relaxed) / 1e9);
+    out << buffer;
+    snprintf(buffer, sizeof(buffer), "%s_count %llu\n", name, (unsigned long long)total);
+    out << buffer;
+}
+
+// ==================== METRICS ====================
+// Users
+MetricCounter Metrics::usersRegistered("social_users_registered_total", "Users created through registerUser.");
+MetricCounter Metrics::logins("social_logins_total", "Successful logins.");
+MetricCounter Metrics::loginFailures("social_login_failures_total", "Logins rejected for an unknown user or wrong password.");
+MetricCounter Metrics::userLookups("social_user_lookups_total", "Lookups by user ID or username.");
+MetricCounter Metrics::followChanges("social_follow_changes_total", "Follow and unfollow operations.");
+MetricCounter Metrics::userSearches("social_user_searches_total", "UserDatabase::searchUsers calls.");
+MetricCounter Metrics::typeaheadNarrowed("social_typeahead_narrowed_total", "Search-as-you-type queries answered by filtering the previous results.");
+MetricGauge Metrics::users("social_users", "Users currently loaded.");
+MetricHistogram Metrics::registerLatency("social_register_user_seconds", "Time spent in UserDatabase::registerUser.");
+MetricHistogram Metrics::loginLatency("social_login_seconds", "Time spent in UserDatabase::login.");
+MetricHistogram Metrics::userSearchLatency("social_user_search_seconds", "Time spent in UserDatabase::searchUsers.");
+MetricHistogram Metrics::recommendLatency("social_recommend_follows_seconds", "Time spent in UserDatabase::recommendFollows.");
+MetricHistogram Metrics::graphAnalyticsLatency("social_graph_analytics_seconds", "Time from a graph analytics snapshot to its results being published.");
+
+// Posts
+MetricCounter Metrics::postsCreated("social_posts_created_total", "Posts created.");
+MetricCounter Metrics::postsDeleted("social_posts_deleted_total", "Posts deleted.");
+MetricCounter Metrics::postLookups("social_post_lookups_total", "PostDatabase::findPost calls.");
+MetricCounter Metrics::likes("social_likes_total", "Likes added to posts.");
+MetricCounter Metrics::comments("social_comments_total", "Comments added to posts, including ones read back by loadFromFile.");
+MetricCounter Metrics::postSearches("social_post_searches_total", "PostDatabase::searchPosts calls.");
+MetricGauge Metrics::posts("social_posts", "Posts currently loaded.");
+MetricHistogram Metrics::findPostLatency("social_find_post_seconds", "Time spent in PostDatabase::findPost.");
+MetricHistogram Metrics::deletePostLatency("social_delete_post_seconds", "Time spent in PostDatabase::deletePost.");
+MetricHistogram Metrics::postSearchLatency("social_post_search_seconds", "Time spent in PostDatabase::searchPosts.");
+
+// Feed
+MetricCounter Metrics::feedsGenerated("social_feeds_generated_total", "Feed::generateFeed calls.");
+MetricHistogram Metrics::generateFeedLatency("social_generate_feed_seconds", "Time spent in Feed::generateFeed.");
+
+// Notifications
+MetricCounter Metrics::notificationsAdded("social_notifications_added_total", "Notifications accepted by the queue.");
+MetricCounter Metrics::notificationsEvicted("social_notifications_evicted_total", "Notifications evicted from memory, oldest first, because their inbox was full.");
+MetricCounter Metrics::notificationsPosted("social_notifications_posted_total", "Notifications handed to the ingestion ring.");
+MetricCounter Metrics::notificationRingFull("social_notification_ring_full_total", "postNotification calls rejected by a full ring.");
+MetricCounter Metrics::notificationsDrained("social_notifications_drained_total", "Notifications moved from the ring into inboxes.");
+MetricCounter Metrics::inboxReplays("social_inbox_replays_total", "Inboxes rebuilt from the notification segment.");
+MetricGauge Metrics::notifications("social_notifications", "Notifications held in memory.");
+MetricGauge Metrics::inboxes("social_notification_inboxes", "Notification inboxes allocated.");
+MetricHistogram Metrics::getNotificationsLatency("social_get_notifications_seconds", "Time spent in NotificationQueue::getAllNotifications.");
+MetricHistogram Metrics::replayLatency("social_inbox_replay_seconds", "Time spent replaying one inbox from the segment.");
+
+// Persistence
+MetricHistogram Metrics::saveLatency("social_save_seconds", "Time spent writing one users, connections or posts file.");
+MetricHistogram Metrics::loadLatency("social_load_seconds", "Time spent reading one users, connections or posts file.");
+
+void Metrics::writePrometheus(ostream& out) {
+    // Registration order depends on static initialization; sort by name so
+    // the output is stable
+    vector<Metric*> all;
+    for (Metric* m = head.load(memory_order_acquire); m; m = m->next) {
+        all.push_back(m);
+    }
+    sort(all.begin(), all.end(), [](const Metric* a, const Metric* b) {
+        return strcmp(a->name, b->name) < 0;
+    });
+
+    for (Metric* m : all) {
+        m->writePrometheus(out);
+    }
+}
+
+bool Metrics::writePrometheusFile(const string& filename) {
+    // Write to a temporary file and rename it over the old one, so a
+    // collector never reads a half-written file
+    string tempName = filename + ".tmp";
+    ofstream file(tempName);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << tempName << " for writing" << endl;
+        return false;
+    }
+    writePrometheus(file);
+    file.close();
+
+    if (rename(tempName.c_str(), filename.c_str()) != 0) {
+        // Windows will not rename over an existing file
+        remove(filename.c_str());
+        if (rename(tempName.c_str(), filename.c_str()) != 0) {
+            cerr << "Error: Could not replace " << filename << endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,13 +1,14 @@
-#include "../include/App.h"
+#include "../include/Core.h"
+#include <filesystem>
 
 // ==================== NOTIFICATION CLASS ====================
 Notification::Notification()
-    : notificationID(0), type(FOLLOW), fromUserID(0), fromUsername(""),
+    : notificationID(0), type(FOLLOW), toUserID(0), fromUserID(0), fromUsername(""),
       postID(0), message(""), isRead(false) {}
 
-Notification::Notification(int id, NotificationType t, int fromID, const string& fromUser,
+Notification::Notification(int id, NotificationType t, int toID, int fromID, const string& fromUser,
                           int pID, const string& msg, Timestamp ts)
-    : notificationID(id), type(t), fromUserID(fromID), fromUsername(fromUser),
+    : notificationID(id), type(t), toUserID(toID), fromUserID(fromID), fromUsername(fromUser),
       postID(pID), message(msg), timestamp(ts), isRead(false) {}
 
 bool Notification::hasHigherPriority(const Notification& other) const {
@@ -17,98 +18,723 @@ bool Notification::hasHigherPriority(const Notification& other) const {
     return timestamp.isEarlier(other.timestamp);
 }
 
+// ==================== NOTIFICATION RING ====================
+NotificationRing::NotificationRing(size_t cap) : enqueuePos(0), dequeuePos(0) {
+    // Round up to a power of two so positions wrap with a mask
+    size_t size = 2;
+    while (size < cap) size *= 2;
+    mask = size - 1;
+    
+    cells = new Cell[size];
+    for (size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, memory_order_relaxed);
+    }
+}
+
+NotificationRing::~NotificationRing() {
+    delete[] cells;
+}
+
+bool NotificationRing::push(PendingNotification& item) {
+    Cell* cell;
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    
+    while (true) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            // Cell is free for this position; claim it
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // Full: consumer has not freed this cell yet
+        } else {
+            pos = enqueuePos.load(memory_order_relaxed); // Another producer won
+        }
+    }
+    
+    cell->value = std::move(item);
+    cell->sequence.store(pos + 1, memory_order_release);
+    return true;
+}
+
+bool NotificationRing::pop(PendingNotification& item) {
+    Cell* cell = &cells[dequeuePos & mask];
+    size_t seq = cell->sequence.load(memory_order_acquire);
+    if (seq != dequeuePos + 1) {
+        return false; // Empty, or the producer is still writing this cell
+    }
+    
+    item = std::move(cell->value);
+    cell->sequence.store(dequeuePos + mask + 1, memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
 // ==================== NOTIFICATION QUEUE CLASS ====================
-NotificationQueue::NotificationQueue(int cap)
-    : capacity(cap), size(0), nextID(1) {
-    heap = new Notification*[capacity];
+NotificationQueue::NotificationQueue(int inboxCap, int pendingCap)
+    : slabs(nullptr), slabCount(0), slotsUsed(0), freeSlots(nullptr), freeCount(0),
+      inboxLimit(max(inboxCap, 1)), size(0), nextID(1), pending(pendingCap), segmentSize(0),
+      segmentIndexUsed(0), segmentIndexed(false) {
+    growSlabs();
+    
+    inboxBuckets = 16;
+    inboxUsed = 0;
+    inboxes = new NotificationInbox[inboxBuckets]();
+    
+    segmentIndexBuckets = 16;
+    segmentIndex = new SegmentIndexEntry[segmentIndexBuckets]();
 }
 
 NotificationQueue::~NotificationQueue() {
-    for (int i = 0; i < size; i++) {
-        delete heap[i];
+    for (int i = 0; i < slabCount; i++) {
+        delete[] slabs[i];
+    }
+    delete[] slabs;
+    delete[] freeSlots;
+    
+    for (int i = 0; i < inboxBuckets; i++) {
+        delete[] inboxes[i].heap;
+    }
+    delete[] inboxes;
+    
+    for (int i = 0; i < segmentIndexBuckets; i++) {
+        delete[] segmentIndex[i].offsets;
+    }
+    delete[] segmentIndex;
+    
+    Metrics::notifications.add(-size);
+    Metrics::inboxes.add(-inboxUsed);
+}
+
+// Iterative d-ary sift: the moving entry is held in a local and written once
+// at its final position instead of swapping at every level.
+void NotificationQueue::heapifyUp(NotificationInbox& inbox, int index) {
+    NotificationHeapEntry* heap = inbox.heap;
+    NotificationHeapEntry entry = heap[index];
+    while (index > 0) {
+        int p = parent(index);
+        if (heap[p].key <= entry.key) break;
+        heap[index] = heap[p];
+        index = p;
+    }
+    heap[index] = entry;
+}
+
+void NotificationQueue::heapifyDown(NotificationInbox& inbox, int index) {
+    NotificationHeapEntry* heap = inbox.heap;
+    int size = inbox.size;
+    NotificationHeapEntry entry = heap[index];
+    while (true) {
+        int first = firstChild(index);
+        if (first >= size) break;
+        
+        // Pick the smallest of up to HEAP_ARITY adjacent children
+        int last = first + HEAP_ARITY < size ? first + HEAP_ARITY : size;
+        int best = first;
+        for (int c = first + 1; c < last; c++) {
+            if (heap[c].key < heap[best].key) best = c;
+        }
+        
+        if (heap[best].key >= entry.key) break;
+        heap[index] = heap[best];
+        index = best;
+    }
+    heap[index] = entry;
+}
+
+int NotificationQueue::allocateSlot() {
+    // Reused slots keep their string buffers, so steady-state ingestion does
+    // not touch the allocator
+    if (freeCount > 0) {
+        return freeSlots[--freeCount];
+    }
+    
+    if (slotsUsed == slabCount * SLAB_SIZE) {
+        growSlabs();
     }
-    delete[] heap;
+    int index = slotsUsed++;
+    Notification*& slab = slabs[index / SLAB_SIZE];
+    if (!slab) {
+        slab = new Notification[SLAB_SIZE];
+    }
+    return index;
 }
 
-void NotificationQueue::swap(int i, int j) {
-    Notification* temp = heap[i];
-    heap[i] = heap[j];
-    heap[j] = temp;
+// Doubles the slab table; slabs themselves are still allocated on first use.
+// freeSlots can then hold every slot there is.
+void NotificationQueue::growSlabs() {
+    int newCount = slabCount > 0 ? slabCount * 2 : 4;
+    Notification** newSlabs = new Notification*[newCount];
+    for (int i = 0; i < newCount; i++) {
+        newSlabs[i] = i < slabCount ? slabs[i] : nullptr;
+    }
+    int* newFree = new int[newCount * SLAB_SIZE];
+    if (freeCount > 0) memcpy(newFree, freeSlots, freeCount * sizeof(int));
+    
+    delete[] slabs;
+    delete[] freeSlots;
+    slabs = newSlabs;
+    freeSlots = newFree;
+    slabCount = newCount;
 }
 
-void NotificationQueue::heapifyUp(int index) {
-    while (index > 0 && heap[index]->hasHigherPriority(*heap[parent(index)])) {
-        swap(index, parent(index));
-        index = parent(index);
+// Removes heap[index] from a full inbox and frees its slot
+void NotificationQueue::evictOldest(NotificationInbox& inbox, int index) {
+    int freed = inbox.heap[index].slot;
+    if (!slot(freed).isRead) inbox.unread--;
+    freeSlots[freeCount++] = freed;
+    
+    inbox.size--;
+    if (index < inbox.size) {
+        inbox.heap[index] = inbox.heap[inbox.size];
+        heapifyUp(inbox, index);
+        heapifyDown(inbox, index);
     }
+    size--;
+    Metrics::notifications.add(-1);
+    Metrics::notificationsEvicted.add();
 }
 
-void NotificationQueue::heapifyDown(int index) {
-    int smallest = index;
-    int left = leftChild(index);
-    int right = rightChild(index);
+void NotificationQueue::releaseInbox(NotificationInbox& inbox) {
+    for (int i = 0; i < inbox.size; i++) {
+        freeSlots[freeCount++] = inbox.heap[i].slot;
+    }
+    size -= inbox.size;
+    Metrics::notifications.add(-inbox.size);
+    inbox.size = 0;
+    inbox.unread = 0;
+    ChangeSignal::raise();
+}
+
+// ==================== INBOX INDEX ====================
+NotificationInbox* NotificationQueue::findInbox(int userID, bool create) {
+    int mask = inboxBuckets - 1;
+    int i = (int)((unsigned)userID * 2654435761u) & mask;
     
-    if (left < size && heap[left]->hasHigherPriority(*heap[smallest])) {
-        smallest = left;
+    // Linear probing
+    while (inboxes[i].userID != 0) {
+        if (inboxes[i].userID == userID) return &inboxes[i];
+        i = (i + 1) & mask;
     }
     
-    if (right < size && heap[right]->hasHigherPriority(*heap[smallest])) {
-        smallest = right;
+    if (!create) return nullptr;
+    
+    // Keep load factor under 1/2
+    if ((inboxUsed + 1) * 2 > inboxBuckets) {
+        growInboxes();
+        return findInbox(userID, true);
     }
     
-    if (smallest != index) {
-        swap(index, smallest);
-        heapifyDown(smallest);
+    NotificationInbox& inbox = inboxes[i];
+    inbox.userID = userID;
+    inbox.capacity = 8;
+    inbox.heap = new NotificationHeapEntry[inbox.capacity];
+    inbox.size = 0;
+    inbox.unread = 0;
+    inbox.loaded = segmentPath.empty(); // Nothing to replay without a segment
+    inboxUsed++;
+    Metrics::inboxes.add(1);
+    return &inbox;
+}
+
+NotificationInbox* NotificationQueue::loadedInbox(int userID) {
+    NotificationInbox* inbox = findInbox(userID, true);
+    if (!inbox->loaded) {
+        replaySegment(*inbox);
     }
+    return inbox;
 }
 
-void NotificationQueue::addNotification(NotificationType type, int fromUserID,
-                                       const string& fromUsername, int postID,
-                                       const string& message, Timestamp timestamp) {
-    if (size >= capacity) {
-        return; // Queue full
+void NotificationQueue::growInboxes() {
+    NotificationInbox* oldInboxes = inboxes;
+    int oldBuckets = inboxBuckets;
+    
+    inboxBuckets *= 2;
+    inboxes = new NotificationInbox[inboxBuckets]();
+    
+    // Move inboxes (and their heaps) to their new buckets
+    int mask = inboxBuckets - 1;
+    for (int b = 0; b < oldBuckets; b++) {
+        if (oldInboxes[b].userID == 0) continue;
+        int i = (int)((unsigned)oldInboxes[b].userID * 2654435761u) & mask;
+        while (inboxes[i].userID != 0) {
+            i = (i + 1) & mask;
+        }
+        inboxes[i] = oldInboxes[b];
     }
     
-    Notification* newNotif = new Notification(nextID++, type, fromUserID,
-                                             fromUsername, postID, message, timestamp);
-    heap[size] = newNotif;
-    heapifyUp(size);
+    delete[] oldInboxes;
+}
+
+// ==================== PRODUCER / CONSUMER ====================
+void NotificationQueue::insertNotification(NotificationInbox& inbox, int id, NotificationType type,
+                                          int fromUserID, const string& fromUsername,
+                                          int postID, const string& message,
+                                          Timestamp timestamp, bool isRead) {
+    if (inbox.size >= inboxLimit) {
+        // Full: the oldest notification goes, whatever its type. The low 56
+        // bits of a key are the packed timestamp; on a tie the lower ID is
+        // the older one.
+        const uint64_t TIME_BITS = (1ULL << 56) - 1;
+        int oldest = 0;
+        for (int i = 1; i < inbox.size; i++) {
+            uint64_t time = inbox.heap[i].key & TIME_BITS;
+            uint64_t oldestTime = inbox.heap[oldest].key & TIME_BITS;
+            if (time < oldestTime || (time == oldestTime &&
+                slot(inbox.heap[i].slot).notificationID < slot(inbox.heap[oldest].slot).notificationID)) {
+                oldest = i;
+            }
+        }
+        if (timestamp.packed() < (inbox.heap[oldest].key & TIME_BITS)) {
+            Metrics::notificationsEvicted.add(); // Older than everything kept
+            return;
+        }
+        evictOldest(inbox, oldest);
+    }
+    
+    if (inbox.size >= inbox.capacity) {
+        int newCapacity = inbox.capacity * 2;
+        NotificationHeapEntry* newHeap = new NotificationHeapEntry[newCapacity];
+        memcpy(newHeap, inbox.heap, inbox.size * sizeof(NotificationHeapEntry));
+        delete[] inbox.heap;
+        inbox.heap = newHeap;
+        inbox.capacity = newCapacity;
+    }
+    
+    int index = allocateSlot();
+    Notification& n = slot(index);
+    n.notificationID = id;
+    n.type = type;
+    n.toUserID = inbox.userID;
+    n.fromUserID = fromUserID;
+    n.fromUsername = fromUsername;
+    n.postID = postID;
+    n.message = message;
+    n.timestamp = timestamp;
+    n.isRead = isRead;
+    
+    inbox.heap[inbox.size].key = n.priorityKey();
+    inbox.heap[inbox.size].slot = index;
+    inbox.size++;
+    heapifyUp(inbox, inbox.size - 1);
+    
+    if (!isRead) inbox.unread++;
     size++;
+    Metrics::notifications.add(1);
+    ChangeSignal::raise();
 }
 
-void NotificationQueue::getAllNotifications(Notification** arr, int& count) {
-    count = size;
+void NotificationQueue::addNotification(int toUserID, NotificationType type, int fromUserID,
+                                       const string& fromUsername, int postID,
+                                       const string& message, Timestamp timestamp) {
+    NotificationInbox* inbox = findInbox(toUserID, !segment.is_open());
+    bool inMemory = inbox && inbox->loaded;
+    
+    Metrics::notificationsAdded.add();
+    int id = nextID++;
+    if (segment.is_open()) {
+        // The segment is the durable record, so it always gets the
+        // notification, even one the inbox will evict right away. Inboxes
+        // that were never viewed only get the record; they pick it up when
+        // they are replayed.
+        Notification n(id, type, toUserID, fromUserID, fromUsername, postID, message, timestamp);
+        appendRecord(RECORD_ADD, toUserID, id, &n);
+    }
     
-    // Create temporary copy to preserve heap
-    Notification** temp = new Notification*[size];
-    int tempSize = size;
+    if (inMemory) {
+        insertNotification(*inbox, id, type, fromUserID, fromUsername, postID,
+                           message, timestamp, false);
+    }
+}
+
+bool NotificationQueue::postNotification(int toUserID, NotificationType type, int fromUserID,
+                                        const string& fromUsername, int postID,
+                                        const string& message, Timestamp timestamp) {
+    PendingNotification item;
+    item.toUserID = toUserID;
+    item.type = type;
+    item.fromUserID = fromUserID;
+    item.fromUsername = fromUsername;
+    item.postID = postID;
+    item.message = message;
+    item.timestamp = timestamp;
+    if (!pending.push(item)) {
+        Metrics::notificationRingFull.add();
+        return false;
+    }
+    Metrics::notificationsPosted.add();
     
-    // Extract all
-    for (int i = 0; i < tempSize; i++) {
-        temp[i] = heap[0];
-        heap[0] = heap[size - 1];
-        size--;
-        heapifyDown(0);
+    // Wake the consumer so it drains on its next frame
+    ChangeSignal::raise();
+    return true;
+}
+
+int NotificationQueue::drainPending() {
+    PendingNotification item;
+    int drained = 0;
+    while (pending.pop(item)) {
+        addNotification(item.toUserID, item.type, item.fromUserID, item.fromUsername,
+                        item.postID, item.message, item.timestamp);
+        drained++;
     }
+    if (drained > 0) Metrics::notificationsDrained.add(drained);
+    return drained;
+}
+
+// ==================== QUERIES ====================
+void NotificationQueue::getAllNotifications(int userID, Notification** arr, int& count, int maxCount) {
+    MetricTimer timer(Metrics::getNotificationsLatency);
+    count = 0;
+    NotificationInbox* inbox = loadedInbox(userID);
+    if (inbox->size == 0 || maxCount <= 0) return;
+    
+    // Save the heap layout so it can be restored without re-heapifying
+    int savedSize = inbox->size;
+    NotificationHeapEntry* saved = new NotificationHeapEntry[savedSize];
+    memcpy(saved, inbox->heap, savedSize * sizeof(NotificationHeapEntry));
     
-    // Copy to output array
-    for (int i = 0; i < tempSize; i++) {
-        arr[i] = temp[i];
+    // Extract the first maxCount in priority order
+    int shown = min(savedSize, maxCount);
+    for (int i = 0; i < shown; i++) {
+        arr[count++] = &slot(inbox->heap[0].slot);
+        inbox->heap[0] = inbox->heap[inbox->size - 1];
+        inbox->size--;
+        heapifyDown(*inbox, 0);
     }
     
     // Restore heap
-    for (int i = 0; i < tempSize; i++) {
-        heap[size] = temp[i];
-        heapifyUp(size);
-        size++;
+    memcpy(inbox->heap, saved, savedSize * sizeof(NotificationHeapEntry));
+    inbox->size = savedSize;
+    
+    delete[] saved;
+}
+
+void NotificationQueue::markAsRead(Notification* notification) {
+    if (!notification || notification->isRead) return;
+    
+    notification->isRead = true;
+    ChangeSignal::raise();
+    NotificationInbox* inbox = findInbox(notification->toUserID, false);
+    if (inbox && inbox->unread > 0) {
+        inbox->unread--;
     }
+    appendRecord(RECORD_READ, notification->toUserID, notification->notificationID);
+}
+
+void NotificationQueue::markAllRead(int userID) {
+    NotificationInbox* inbox = loadedInbox(userID);
+    if (inbox->unread == 0) return;
     
-    delete[] temp;
+    for (int i = 0; i < inbox->size; i++) {
+        slot(inbox->heap[i].slot).isRead = true;
+    }
+    inbox->unread = 0;
+    ChangeSignal::raise();
+    appendRecord(RECORD_READ_ALL, userID, 0);
+}
+
+int NotificationQueue::getUnreadCount(int userID) {
+    return loadedInbox(userID)->unread;
+}
+
+void NotificationQueue::clearInbox(int userID) {
+    NotificationInbox* inbox = findInbox(userID, false);
+    if (inbox) {
+        releaseInbox(*inbox);
+    }
+    appendRecord(RECORD_CLEAR, userID, 0);
 }
 
 void NotificationQueue::clearAll() {
-    for (int i = 0; i < size; i++) {
-        delete heap[i];
+    // Slabs and inbox heaps stay allocated for reuse
+    for (int i = 0; i < inboxBuckets; i++) {
+        if (inboxes[i].userID != 0) {
+            releaseInbox(inboxes[i]);
+        }
+    }
+    appendRecord(RECORD_CLEAR, 0, 0);
+}
+
+// ==================== SEGMENT FILE ====================
+// Every record is framed as [u32 length][body][u32 length] so the file can be
+// walked forwards (skipping other users' records) and backwards (to recover
+// nextID from the tail). The body starts with [u8 kind][i32 userID][i32 id];
+// RECORD_ADD bodies continue with [u8 type][i32 fromUserID][i32 postID]
+// [u64 packed timestamp][u16 len][fromUsername][u16 len][message].
+
+template <typename T>
+static void writeValue(string& buffer, T value) {
+    buffer.append((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+static bool readValue(istream& in, T& value) {
+    return (bool)in.read((char*)&value, sizeof(T));
+}
+
+static void writeString(string& buffer, const string& text) {
+    uint16_t length = (uint16_t)min(text.size(), (size_t)65535);
+    writeValue(buffer, length);
+    buffer.append(text.data(), length);
+}
+
+static bool readString(istream& in, string& text) {
+    uint16_t length;
+    if (!readValue(in, length)) return false;
+    text.resize(length);
+    return length == 0 || (bool)in.read(&text[0], length);
+}
+
+void NotificationQueue::appendRecord(NotificationRecordKind kind, int userID, int notificationID,
+                                     const Notification* n) {
+    if (!segment.is_open()) return;
+    
+    string body;
+    writeValue(body, (uint8_t)kind);
+    writeValue(body, (int32_t)userID);
+    writeValue(body, (int32_t)notificationID);
+    if (kind == RECORD_ADD && n) {
+        writeValue(body, (uint8_t)n->type);
+        writeValue(body, (int32_t)n->fromUserID);
+        writeValue(body, (int32_t)n->postID);
+        writeValue(body, n->timestamp.packed());
+        writeString(body, n->fromUsername);
+        writeString(body, n->message);
+    }
+    
+    uint32_t length = (uint32_t)body.size();
+    segment.write((const char*)&length, sizeof(length));
+    segment.write(body.data(), body.size());
+    segment.write((const char*)&length, sizeof(length));
+    segment.flush();
+    
+    long long offset = segmentSize;
+    segmentSize += 2 * sizeof(uint32_t) + length;
+    if (segmentIndexed) indexRecord(kind, userID, offset);
+}
+
+// ==================== SEGMENT INDEX ====================
+SegmentIndexEntry* NotificationQueue::findIndexEntry(int userID, bool create) {
+    int mask = segmentIndexBuckets - 1;
+    int i = (int)((unsigned)userID * 2654435761u) & mask;
+    while (segmentIndex[i].userID != 0) {
+        if (segmentIndex[i].userID == userID) return &segmentIndex[i];
+        i = (i + 1) & mask;
+    }
+    
+    if (!create) return nullptr;
+    if ((segmentIndexUsed + 1) * 2 > segmentIndexBuckets) {
+        growSegmentIndex();
+        return findIndexEntry(userID, true);
     }
-    size = 0;
-}
\ No newline at end of file
+    
+    SegmentIndexEntry& entry = segmentIndex[i];
+    entry.userID = userID;
+    entry.offsets = nullptr;
+    entry.count = 0;
+    entry.capacity = 0;
+    segmentIndexUsed++;
+    return &entry;
+}
+
+void NotificationQueue::growSegmentIndex() {
+    SegmentIndexEntry* oldIndex = segmentIndex;
+    int oldBuckets = segmentIndexBuckets;
+    
+    segmentIndexBuckets *= 2;
+    segmentIndex = new SegmentIndexEntry[segmentIndexBuckets]();
+    
+    int mask = segmentIndexBuckets - 1;
+    for (int b = 0; b < oldBuckets; b++) {
+        if (oldIndex[b].userID == 0) continue;
+        int i = (int)((unsigned)oldIndex[b].userID * 2654435761u) & mask;
+        while (segmentIndex[i].userID != 0) {
+            i = (i + 1) & mask;
+        }
+        segmentIndex[i] = oldIndex[b];
+    }
+    
+    delete[] oldIndex;
+}
+
+// A clear makes every earlier record of its inbox (or of all inboxes)
+// irrelevant, so it empties their lists instead of being stored itself.
+// Loaded inboxes are never replayed again and aren't indexed.
+void NotificationQueue::indexRecord(NotificationRecordKind kind, int userID, long long offset) {
+    if (kind == RECORD_CLEAR && userID == 0) {
+        for (int i = 0; i < segmentIndexBuckets; i++) {
+            segmentIndex[i].count = 0;
+        }
+        return;
+    }
+    
+    NotificationInbox* inbox = findInbox(userID, false);
+    if (inbox && inbox->loaded) return;
+    
+    SegmentIndexEntry* entry = findIndexEntry(userID, true);
+    if (kind == RECORD_CLEAR) {
+        entry->count = 0;
+        return;
+    }
+    if (entry->count == entry->capacity) {
+        int newCapacity = entry->capacity > 0 ? entry->capacity * 2 : 8;
+        long long* newOffsets = new long long[newCapacity];
+        if (entry->count > 0) memcpy(newOffsets, entry->offsets, entry->count * sizeof(long long));
+        delete[] entry->offsets;
+        entry->offsets = newOffsets;
+        entry->capacity = newCapacity;
+    }
+    entry->offsets[entry->count++] = offset;
+}
+
+// One pass over the whole segment, reading only record headers. Its cost
+// grows with the file, but it is paid once per run rather than once per
+// inbox.
+void NotificationQueue::indexSegment() {
+    segmentIndexed = true;
+    ifstream in(segmentPath, ios::binary);
+    if (!in.is_open()) return;
+    
+    long long offset = 0;
+    uint32_t length, trailer;
+    while (offset < segmentSize && readValue(in, length)) {
+        uint8_t kind;
+        int32_t userID, id;
+        if (length < 9 || !readValue(in, kind) || !readValue(in, userID) || !readValue(in, id)) break;
+        in.ignore(length - 9);
+        if (!readValue(in, trailer) || trailer != length) break;
+        
+        indexRecord((NotificationRecordKind)kind, userID, offset);
+        offset += 2 * sizeof(uint32_t) + length;
+    }
+}
+
+void NotificationQueue::replaySegment(NotificationInbox& inbox) {
+    MetricTimer timer(Metrics::replayLatency);
+    Metrics::inboxReplays.add();
+    if (!segmentIndexed) indexSegment(); // Before marking loaded, or it skips this inbox
+    inbox.loaded = true;
+    SegmentIndexEntry* entry = findIndexEntry(inbox.userID, false);
+    if (!entry || entry->count == 0) return;
+    
+    ifstream in(segmentPath, ios::binary);
+    if (in.is_open()) {
+        // Only this user's records, in file order; each was checked when
+        // it was indexed
+        for (int r = 0; r < entry->count; r++) {
+            in.seekg(entry->offsets[r] + (long long)sizeof(uint32_t));
+            uint8_t kind;
+            int32_t userID, id;
+            if (!readValue(in, kind) || !readValue(in, userID) || !readValue(in, id)) break;
+            
+            if (kind == RECORD_ADD) {
+                uint8_t type;
+                int32_t fromUserID, postID;
+                uint64_t packedTime;
+                string fromUsername, message;
+                if (!readValue(in, type) || !readValue(in, fromUserID) || !readValue(in, postID) ||
+                    !readValue(in, packedTime) || !readString(in, fromUsername) ||
+                    !readString(in, message)) break;
+                insertNotification(inbox, id, (NotificationType)type, fromUserID, fromUsername,
+                                   postID, message, Timestamp::unpack(packedTime), false);
+            } else if (kind == RECORD_READ) {
+                for (int i = 0; i < inbox.size; i++) {
+                    Notification& n = slot(inbox.heap[i].slot);
+                    if (n.notificationID == id && !n.isRead) {
+                        n.isRead = true;
+                        inbox.unread--;
+                        break;
+                    }
+                }
+            } else if (kind == RECORD_READ_ALL) {
+                for (int i = 0; i < inbox.size; i++) {
+                    slot(inbox.heap[i].slot).isRead = true;
+                }
+                inbox.unread = 0;
+            }
+        }
+    }
+    
+    // The inbox is authoritative from now on
+    delete[] entry->offsets;
+    entry->offsets = nullptr;
+    entry->count = 0;
+    entry->capacity = 0;
+}
+
+void NotificationQueue::openSegment(const string& filename) {
+    segmentPath = filename;
+    
+    // Walk back from the tail to the last RECORD_ADD to recover nextID.
+    // Nothing else is read, so startup cost does not depend on inbox sizes.
+    ifstream in(filename, ios::binary | ios::ate);
+    if (in.is_open()) {
+        streamoff pos = in.tellg();
+        bool intact = true;
+        uint32_t length, header;
+        while (pos > 0) {
+            intact = false;
+            if (pos < (streamoff)(2 * sizeof(uint32_t) + 9)) break;
+            in.seekg(pos - (streamoff)sizeof(uint32_t));
+            if (!readValue(in, length)) break;
+            streamoff start = pos - (streamoff)sizeof(uint32_t) - length - (streamoff)sizeof(uint32_t);
+            if (start < 0) break;
+            
+            in.seekg(start);
+            uint8_t kind;
+            int32_t userID, id;
+            if (!readValue(in, header) || header != length || !readValue(in, kind) ||
+                !readValue(in, userID) || !readValue(in, id)) {
+                break;
+            }
+            intact = true;
+            if (kind == RECORD_ADD) {
+                if (id >= nextID) nextID = id + 1;
+                break;
+            }
+            pos = start;
+        }
+        
+        if (!intact) {
+            // Torn tail (e.g. crash mid-write): scan forwards for the last
+            // complete record and cut the file there before appending to it
+            in.clear();
+            in.seekg(0);
+            streamoff validEnd = 0;
+            uint32_t trailer;
+            while (readValue(in, length)) {
+                streamoff start = in.tellg();
+                uint8_t kind;
+                int32_t userID, id;
+                if (!readValue(in, kind) || !readValue(in, userID) || !readValue(in, id)) break;
+                in.seekg(start + (streamoff)length);
+                if (!readValue(in, trailer) || trailer != length) break;
+                if (kind == RECORD_ADD && id >= nextID) nextID = id + 1;
+                validEnd = in.tellg();
+            }
+            in.close();
+            
+            cerr << "Warning: truncating damaged tail of " << filename << endl;
+            filesystem::resize_file(filename, validEnd);
+        }
+    }
+    
+    segment.open(filename, ios::binary | ios::app);
+    if (!segment.is_open()) {
+        cerr << "Error: Could not open " << filename << " for writing" << endl;
+        segmentPath.clear();
+        return;
+    }
+    error_code error;
+    uintmax_t bytes = filesystem::file_size(filename, error);
+    segmentSize = error ? 0 : (long long)bytes;
+    segmentIndexed = false; // Indexed on the first replay
+    
+    // Inboxes already in memory are authoritative; mark them loaded so the
+    // segment is not replayed on top of them
+    for (int i = 0; i < inboxBuckets; i++) {
+        if (inboxes[i].userID != 0) inboxes[i].loaded = true;
+    }
+}
@@ -1,4 +1,24 @@
-#include "App.h"
+#include "Core.h"
+
+// Timestamps are local time, as getCurrentTimestamp() makes them. mktime()
+// costs about 2 us and a load converts every post and comment, mostly in
+// runs from the same hour, so the start of the last hour is remembered.
+static time_t toEpoch(const Timestamp& ts) {
+    thread_local uint64_t cachedHour = ~0ull;
+    thread_local time_t cachedBase = 0;
+    uint64_t hour = ts.packed() >> 16;
+    if (hour != cachedHour) {
+        tm t = {};
+        t.tm_year = ts.year - 1900;
+        t.tm_mon = ts.month - 1;
+        t.tm_mday = ts.day;
+        t.tm_hour = ts.hour;
+        t.tm_isdst = -1;
+        cachedBase = mktime(&t);
+        cachedHour = hour;
+    }
+    return cachedBase + ts.minute * 60 + ts.second;
+}
 
 // ==================== COMMENT CLASS ====================
 Comment::Comment(int id, int uid, const string& uname, const string& text, Timestamp ts)
@@ -7,7 +27,7 @@ Comment::Comment(int id, int uid, const string& uname, const string& text, Times
 // ==================== POST CLASS ====================
 Post::Post(int pid, int uid, const string& uname, const string& text, Timestamp ts)
     : postID(pid), userID(uid), username(uname), content(text), timestamp(ts),
-      likes(0), commentCount(0), comments(nullptr), prev(nullptr), next(nullptr) {}
+      likes(0), commentCount(0), comments(nullptr), prev(nullptr), next(nullptr), searchUnit(-1) {}
 
 Post::~Post() {
     // Delete all comments
@@ -21,10 +41,13 @@ Post::~Post() {
 
 void Post::addLike() {
     likes++;
+    Metrics::likes.add();
+    ChangeSignal::raise();
 }
 
 void Post::addComment(int uid, const string& uname, const string& text, Timestamp ts) {
     Comment* newComment = new Comment(commentCount++, uid, uname, text, ts);
+    Metrics::comments.add();
     
     if (!comments) {
         comments = newComment;
@@ -35,18 +58,23 @@ void Post::addComment(int uid, const string& uname, const string& text, Timestam
         }
         current->next = newComment;
     }
+    ChangeSignal::raise();
 }
 
 // ==================== POST DATABASE CLASS ====================
-PostDatabase::PostDatabase() : head(nullptr), tail(nullptr), nextPostID(1001), nextCommentID(1) {}
+PostDatabase::PostDatabase()
+    : head(nullptr), tail(nullptr), nextPostID(1001), nextCommentID(1), version(0) {}
 
 PostDatabase::~PostDatabase() {
+    int removed = 0;
     Post* current = head;
     while (current) {
         Post* temp = current;
         current = current->next;
         delete temp;
+        removed++;
     }
+    Metrics::posts.add(-removed);
 }
 
 Post* PostDatabase::createPost(int userID, const string& username, const string& content, Timestamp ts) {
@@ -65,10 +93,18 @@ Post* PostDatabase::createPost(int userID, const string& username, const string&
         head = newPost;
     }
     
+    searchIndex.addText(newPost, content);
+    indexTags(newPost, toEpoch(ts));
+    version++;
+    Metrics::postsCreated.add();
+    Metrics::posts.add(1);
+    ChangeSignal::raise();
     return newPost;
 }
 
 bool PostDatabase::deletePost(int postID) {
+    MetricTimer timer(Metrics::deletePostLatency);
+    
     Post* post = findPost(postID);
     if (!post) return false;
     
@@ -85,11 +121,21 @@ bool PostDatabase::deletePost(int postID) {
         tail = post->prev;
     }
     
+    searchIndex.removePost(post);
+    unindexTags(post);
+    trending.forgetPost(post);
     delete post;
+    version++;
+    Metrics::postsDeleted.add();
+    Metrics::posts.add(-1);
+    ChangeSignal::raise();
     return true;
 }
 
 Post* PostDatabase::findPost(int postID) {
+    MetricTimer timer(Metrics::findPostLatency);
+    Metrics::postLookups.add();
+    
     Post* current = head;
     while (current) {
         if (current->postID == postID) {
@@ -100,6 +146,75 @@ Post* PostDatabase::findPost(int postID) {
     return nullptr;
 }
 
+void PostDatabase::addComment(Post* post, int userID, const string& username, const string& text, Timestamp ts) {
+    post->addComment(userID, username, text, ts);
+    searchIndex.addText(post, text);
+    trending.recordPost(post, 2.0, toEpoch(ts));
+}
+
+void PostDatabase::addLike(Post* post) {
+    post->addLike();
+    trending.recordPost(post, 1.0, time(0));
+}
+
+int PostDatabase::searchPosts(const string& query, Post** results, int maxResults) {
+    MetricTimer timer(Metrics::postSearchLatency);
+    Metrics::postSearches.add();
+    return searchIndex.search(query, results, maxResults);
+}
+
+// ==================== HASHTAGS AND MENTIONS ====================
+void PostDatabase::indexTags(Post* post, time_t when) {
+    vector<string> hashtags, mentions;
+    extractTags(post->content, hashtags, mentions);
+    for (const string& tag : hashtags) {
+        hashtagIndex.add(tag, post);
+        trending.recordTag(tag, 1.0, when);
+    }
+    for (const string& name : mentions) mentionIndex.add(name, post);
+}
+
+void PostDatabase::unindexTags(Post* post) {
+    vector<string> hashtags, mentions;
+    extractTags(post->content, hashtags, mentions);
+    for (const string& tag : hashtags) hashtagIndex.remove(tag, post);
+    for (const string& name : mentions) mentionIndex.remove(name, post);
+}
+
+int PostDatabase::getTagPosts(const string& tag, Post** results, int maxResults) {
+    string key = tag;
+    for (char& c : key) c = (char)tolower((unsigned char)c);
+    return hashtagIndex.get(key, results, maxResults);
+}
+
+int PostDatabase::getMentions(const string& username, Post** results, int maxResults) {
+    return mentionIndex.get(username, results, maxResults);
+}
+
+int PostDatabase::notifyMentions(Post* post, UserDatabase* users, NotificationQueue* notifications) {
+    vector<string> hashtags, mentions;
+    extractTags(post->content, hashtags, mentions);
+    int sent = 0;
+    for (const string& name : mentions) {
+        User* mentioned = users->searchByUsername(name);
+        if (!mentioned || mentioned->userID == post->userID) continue;
+        notifications->addNotification(mentioned->userID, MENTION, post->userID, post->username,
+                                       post->postID, post->username + " mentioned you in a post",
+                                       post->timestamp);
+        sent++;
+    }
+    return sent;
+}
+
+// ==================== TRENDING ====================
+int PostDatabase::getTrendingTags(string* tags, double* scores, int maxResults) {
+    return trending.topTags(tags, scores, maxResults, time(0));
+}
+
+int PostDatabase::getTrendingPosts(Post** results, double* scores, int maxResults) {
+    return trending.topPosts(results, scores, maxResults, time(0));
+}
+
 // ==================== UTILITY FUNCTIONS ====================
 Timestamp getCurrentTimestamp() {
     time_t now = time(0);
@@ -182,42 +297,43 @@ void PostDatabase::generateDummyPosts(UserDatabase* userDB) {
         hoursAgo(15));
     
     // Add some likes to posts
-    if (post1) post1->addLike();
-    if (post2) { post2->addLike(); post2->addLike(); }
-    if (post3) post3->addLike();
-    if (post4) { post4->addLike(); post4->addLike(); post4->addLike(); }
-    if (post5) { post5->addLike(); post5->addLike(); }
-    if (post7) post7->addLike();
-    if (post10) { post10->addLike(); post10->addLike(); post10->addLike(); post10->addLike(); }
+    if (post1) addLike(post1);
+    if (post2) { addLike(post2); addLike(post2); }
+    if (post3) addLike(post3);
+    if (post4) { addLike(post4); addLike(post4); addLike(post4); }
+    if (post5) { addLike(post5); addLike(post5); }
+    if (post7) addLike(post7);
+    if (post10) { addLike(post10); addLike(post10); addLike(post10); addLike(post10); }
     
     // Add some comments
     if (post10) {
-        post10->addComment(bob->userID, bob->username, 
+        addComment(post10, bob->userID, bob->username, 
             "Welcome Alice! Glad to have you here!", hoursAgo(14));
-        post10->addComment(charlie->userID, charlie->username, 
+        addComment(post10, charlie->userID, charlie->username, 
             "Hey Alice! Looking forward to your posts!", hoursAgo(14));
-        post10->addComment(eve->userID, eve->username, 
+        addComment(post10, eve->userID, eve->username, 
             "Welcome to the community! 🎉", hoursAgo(13));
     }
     
     if (post5) {
-        post5->addComment(bob->userID, bob->username, 
+        addComment(post5, bob->userID, bob->username, 
             "ImGui is awesome! What are you building?", hoursAgo(4));
     }
     
     if (post4) {
-        post4->addComment(charlie->userID, charlie->username, 
+        addComment(post4, charlie->userID, charlie->username, 
             "I'm interested! What game?", hoursAgo(3));
     }
     
     if (post2) {
-        post2->addComment(eve->userID, eve->username, 
+        addComment(post2, eve->userID, eve->username, 
             "Beautiful shot! What camera do you use?", hoursAgo(1));
     }
 }
 
 // ==================== FILE HANDLING ====================
 void PostDatabase::saveToFile(const string& filename) {
+    MetricTimer timer(Metrics::saveLatency);
     ofstream file(filename);
     if (!file.is_open()) {
         cerr << "Error: Could not open " << filename << " for writing" << endl;
@@ -268,6 +384,7 @@ void PostDatabase::saveToFile(const string& filename) {
 }
 
 void PostDatabase::loadFromFile(const string& filename) {
+    MetricTimer timer(Metrics::loadLatency);
     ifstream file(filename);
     if (!file.is_open()) {
         cout << "No existing posts file found. Starting fresh." << endl;
@@ -296,6 +413,8 @@ void PostDatabase::loadFromFile(const string& filename) {
         // Create post directly
         Post* post = new Post(postID, userID, username, content, ts);
         post->likes = likes;
+        searchIndex.addText(post, content);
+        indexTags(post, toEpoch(ts));
         
         // Insert at tail to maintain order
         if (!head) {
@@ -330,22 +449,34 @@ void PostDatabase::loadFromFile(const string& filename) {
                      >> commentTS.hour >> commentTS.minute >> commentTS.second;
                 file.ignore();
                 
-                post->addComment(commentUserID, commentUsername, commentContent, commentTS);
+                addComment(post, commentUserID, commentUsername, commentContent, commentTS);
             }
         }
     }
     
     file.close();
+    version++;
+    Metrics::posts.add(postCount);
+    ChangeSignal::raise();
     cout << "Loaded " << postCount << " posts from " << filename << endl;
 }
 
 void PostDatabase::clearAll() {
+    int removed = 0;
     Post* current = head;
     while (current) {
         Post* temp = current;
         current = current->next;
         delete temp;
+        removed++;
     }
+    Metrics::posts.add(-removed);
+    searchIndex.clear();
+    hashtagIndex.clear();
+    mentionIndex.clear();
+    trending.clear();
     head = tail = nullptr;
     nextPostID = 1001;
+    version++;
+    ChangeSignal::raise();
 }
\ No newline at end of file
@@ -0,0 +1,567 @@
+#include "../include/Core.h"
+#include <cmath>
+
+// ==================== TOKENIZER ====================
+static const int MAX_TOKEN_BYTES = 32;
+
+// Letters and digits are word characters, lowercased; bytes of multi-byte
+// UTF-8 sequences are too, so non-Latin words and emoji stay whole
+static inline bool isWordByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+static void tokenize(const string& text, vector<string>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && !isWordByte((unsigned char)text[i])) i++;
+        if (i >= text.size()) break;
+        string token;
+        while (i < text.size() && isWordByte((unsigned char)text[i])) {
+            if ((int)token.size() < MAX_TOKEN_BYTES) token += (char)tolower((unsigned char)text[i]);
+            i++;
+        }
+        tokens.push_back(token);
+    }
+}
+
+// ==================== VARINT ====================
+static inline void writeVarint(unsigned char*& out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+}
+
+static inline uint32_t readVarint(const unsigned char*& in) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        value |= (uint32_t)(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return value | ((uint32_t)*in++ << shift);
+}
+
+// ==================== INDEX ====================
+PostSearchIndex::PostSearchIndex()
+    : termTable(nullptr), termText(nullptr), postings(nullptr),
+      unitPost(nullptr), unitLength(nullptr), unitAlive(nullptr), unitNext(nullptr) {
+    clear();
+}
+
+PostSearchIndex::~PostSearchIndex() {
+    for (int t = 0; t < termCount; t++) {
+        delete[] postings[t].bytes;
+    }
+    delete[] termTable;
+    delete[] termText;
+    delete[] postings;
+    delete[] unitPost;
+    delete[] unitLength;
+    delete[] unitAlive;
+    delete[] unitNext;
+}
+
+void PostSearchIndex::clear() {
+    if (postings) {
+        for (int t = 0; t < termCount; t++) {
+            delete[] postings[t].bytes;
+        }
+    }
+    delete[] termTable;
+    delete[] termText;
+    delete[] postings;
+    delete[] unitPost;
+    delete[] unitLength;
+    delete[] unitAlive;
+    delete[] unitNext;
+
+    termTableSize = 1024;
+    termTable = new int[termTableSize];
+    for (int i = 0; i < termTableSize; i++) termTable[i] = -1;
+    termCount = 0;
+    termCapacity = 256;
+    termText = new string[termCapacity];
+    postings = new TermPostings[termCapacity];
+
+    unitCount = 0;
+    unitCapacity = 256;
+    unitPost = new Post*[unitCapacity];
+    unitLength = new int[unitCapacity];
+    unitAlive = new bool[unitCapacity];
+    unitNext = new int[unitCapacity];
+    liveUnits = 0;
+    liveLength = 0;
+}
+
+int PostSearchIndex::findTerm(const string& term, bool create) {
+    int mask = termTableSize - 1;
+    int index = (int)(fnv1a(term) & (uint32_t)mask);
+    while (termTable[index] >= 0) {
+        if (termText[termTable[index]] == term) return termTable[index];
+        index = (index + 1) & mask;
+    }
+    if (!create) return -1;
+
+    if ((termCount + 1) * 2 > termTableSize) {
+        growTermTable();
+        return findTerm(term, true);
+    }
+    if (termCount == termCapacity) {
+        int newCapacity = termCapacity * 2;
+        string* newText = new string[newCapacity];
+        TermPostings* newPostings = new TermPostings[newCapacity];
+        for (int t = 0; t < termCount; t++) {
+            newText[t].swap(termText[t]);
+            newPostings[t] = postings[t];
+        }
+        delete[] termText;
+        delete[] postings;
+        termText = newText;
+        postings = newPostings;
+        termCapacity = newCapacity;
+    }
+
+    int id = termCount++;
+    termText[id] = term;
+    postings[id].capacity = 16;
+    postings[id].bytes = new unsigned char[postings[id].capacity];
+    postings[id].size = 0;
+    postings[id].lastUnit = 0;
+    postings[id].df = 0;
+    termTable[index] = id;
+    return id;
+}
+
+void PostSearchIndex::growTermTable() {
+    delete[] termTable;
+    termTableSize *= 2;
+    termTable = new int[termTableSize];
+    for (int i = 0; i < termTableSize; i++) termTable[i] = -1;
+
+    int mask = termTableSize - 1;
+    for (int t = 0; t < termCount; t++) {
+        int index = (int)(fnv1a(termText[t]) & (uint32_t)mask);
+        while (termTable[index] >= 0) index = (index + 1) & mask;
+        termTable[index] = t;
+    }
+}
+
+void PostSearchIndex::appendPosting(int term, int unit, const int* positions, int count) {
+    TermPostings& list = postings[term];
+    int worstCase = 5 * (count + 2);
+    if (list.size + worstCase > list.capacity) {
+        int newCapacity = list.capacity * 2;
+        while (newCapacity < list.size + worstCase) newCapacity *= 2;
+        unsigned char* newBytes = new unsigned char[newCapacity];
+        memcpy(newBytes, list.bytes, list.size);
+        delete[] list.bytes;
+        list.bytes = newBytes;
+        list.capacity = newCapacity;
+    }
+
+    // Unit numbers start at 0, so the first delta is the unit itself
+    unsigned char* out = list.bytes + list.size;
+    writeVarint(out, (uint32_t)(unit - list.lastUnit));
+    writeVarint(out, (uint32_t)count);
+    int previous = 0;
+    for (int i = 0; i < count; i++) {
+        writeVarint(out, (uint32_t)(positions[i] - previous));
+        previous = positions[i];
+    }
+    list.size = (int)(out - list.bytes);
+    list.lastUnit = unit;
+    list.df++;
+}
+
+void PostSearchIndex::addText(Post* post, const string& text) {
+    vector<string> tokens;
+    tokenize(text, tokens);
+    if (tokens.empty()) return;
+
+    if (unitCount == unitCapacity) {
+        int newCapacity = unitCapacity * 2;
+        Post** newPost = new Post*[newCapacity];
+        int* newLength = new int[newCapacity];
+        bool* newAlive = new bool[newCapacity];
+        int* newNext = new int[newCapacity];
+        memcpy(newPost, unitPost, unitCount * sizeof(Post*));
+        memcpy(newLength, unitLength, unitCount * sizeof(int));
+        memcpy(newAlive, unitAlive, unitCount * sizeof(bool));
+        memcpy(newNext, unitNext, unitCount * sizeof(int));
+        delete[] unitPost;
+        delete[] unitLength;
+        delete[] unitAlive;
+        delete[] unitNext;
+        unitPost = newPost;
+        unitLength = newLength;
+        unitAlive = newAlive;
+        unitNext = newNext;
+        unitCapacity = newCapacity;
+    }
+    int unit = unitCount++;
+    unitPost[unit] = post;
+    unitLength[unit] = (int)tokens.size();
+    unitAlive[unit] = true;
+    // A post left over from before a clear() points at nothing valid
+    int previous = post->searchUnit;
+    bool chained = previous >= 0 && previous < unit && unitPost[previous] == post;
+    unitNext[unit] = chained ? previous : -1;
+    post->searchUnit = unit;
+    liveUnits++;
+    liveLength += (long long)tokens.size();
+
+    // Group positions by term: (term, position) pairs sorted by term
+    vector<pair<int, int>> occurrences;
+    occurrences.reserve(tokens.size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        occurrences.push_back(make_pair(findTerm(tokens[i], true), (int)i));
+    }
+    sort(occurrences.begin(), occurrences.end());
+
+    vector<int> positions;
+    size_t i = 0;
+    while (i < occurrences.size()) {
+        int term = occurrences[i].first;
+        positions.clear();
+        while (i < occurrences.size() && occurrences[i].first == term) {
+            positions.push_back(occurrences[i].second);
+            i++;
+        }
+        appendPosting(term, unit, positions.data(), (int)positions.size());
+    }
+}
+
+// Walks only the post's own units (its text and its comments')
+void PostSearchIndex::removePost(Post* post) {
+    int u = post->searchUnit;
+    if (u >= unitCount || (u >= 0 && unitPost[u] != post)) u = -1;
+    while (u >= 0) {
+        if (unitAlive[u]) {
+            unitAlive[u] = false;
+            liveUnits--;
+            liveLength -= unitLength[u];
+        }
+        u = unitNext[u];
+    }
+    post->searchUnit = -1;
+    int deadUnits = unitCount - liveUnits;
+    if (deadUnits > 1024 && deadUnits > liveUnits) compact();
+}
+
+// Re-encodes every list without dead units and renumbers the rest
+void PostSearchIndex::compact() {
+    int* remap = new int[unitCount];
+    int next = 0;
+    for (int u = 0; u < unitCount; u++) {
+        if (unitAlive[u]) {
+            remap[u] = next;
+            unitPost[next] = unitPost[u];
+            unitLength[next] = unitLength[u];
+            unitAlive[next] = true;
+            next++;
+        } else {
+            remap[u] = -1;
+        }
+    }
+    // A live post's units are all live, so its chain maps over whole. New
+    // numbers never exceed old ones, so a post's searchUnit can't be
+    // mistaken for a unit still to be visited.
+    for (int u = 0; u < unitCount; u++) {
+        if (remap[u] < 0) continue;
+        int previous = unitNext[u];
+        unitNext[remap[u]] = previous >= 0 ? remap[previous] : -1;
+        Post* post = unitPost[remap[u]];
+        if (post->searchUnit == u) post->searchUnit = remap[u];
+    }
+
+    vector<int> positions;
+    for (int t = 0; t < termCount; t++) {
+        TermPostings& list = postings[t];
+        unsigned char* oldBytes = list.bytes;
+        const unsigned char* in = oldBytes;
+        const unsigned char* end = oldBytes + list.size;
+
+        list.bytes = new unsigned char[list.capacity];
+        list.size = 0;
+        list.lastUnit = 0;
+        list.df = 0;
+
+        int unit = 0;
+        while (in < end) {
+            unit += (int)readVarint(in);
+            int tf = (int)readVarint(in);
+            positions.clear();
+            int position = 0;
+            for (int k = 0; k < tf; k++) {
+                position += (int)readVarint(in);
+                positions.push_back(position);
+            }
+            if (remap[unit] >= 0) appendPosting(t, remap[unit], positions.data(), tf);
+        }
+        delete[] oldBytes;
+    }
+
+    unitCount = next;
+    delete[] remap;
+}
+
+long long PostSearchIndex::getPostingBytes() {
+    long long total = 0;
+    for (int t = 0; t < termCount; t++) total += postings[t].size;
+    return total;
+}
+
+// ==================== QUERIES ====================
+static const double BM25_K1 = 1.2;
+static const double BM25_B = 0.75;
+
+double PostSearchIndex::idf(int term) {
+    double df = min(postings[term].df, max(liveUnits, 1));
+    return log(1.0 + (liveUnits - df + 0.5) / (df + 0.5));
+}
+
+static double bm25(double tf, double idf, int length, double averageLength) {
+    double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * length / averageLength);
+    return idf * tf * (BM25_K1 + 1.0) / (tf + norm);
+}
+
+// Sorts by post and sums the scores of a post's units
+static void collapseByPost(vector<PostSearchIndex::Hit>& hits) {
+    sort(hits.begin(), hits.end(), [](const PostSearchIndex::Hit& a, const PostSearchIndex::Hit& b) {
+        return a.postID < b.postID;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < hits.size(); i++) {
+        if (out > 0 && hits[out - 1].postID == hits[i].postID) {
+            hits[out - 1].score += hits[i].score;
+        } else {
+            hits[out++] = hits[i];
+        }
+    }
+    hits.resize(out);
+}
+
+void PostSearchIndex::termHits(int term, vector<Hit>& hits) {
+    hits.clear();
+    double termIdf = idf(term);
+    double averageLength = liveUnits > 0 ? (double)liveLength / liveUnits : 1.0;
+
+    const unsigned char* in = postings[term].bytes;
+    const unsigned char* end = in + postings[term].size;
+    int unit = 0;
+    while (in < end) {
+        unit += (int)readVarint(in);
+        int tf = (int)readVarint(in);
+        for (int k = 0; k < tf; k++) readVarint(in); // Positions are not needed
+        if (!unitAlive[unit]) continue;
+        Hit hit = { unitPost[unit]->postID, bm25(tf, termIdf, unitLength[unit], averageLength), unitPost[unit] };
+        hits.push_back(hit);
+    }
+    collapseByPost(hits);
+}
+
+// Units where terms[0..count) occur at consecutive positions; the phrase
+// frequency is scored with the summed idf of its words
+void PostSearchIndex::phraseHits(const int* terms, int count, vector<Hit>& hits) {
+    hits.clear();
+
+    // Candidate units with the positions where the phrase could start
+    struct Candidate {
+        int unit;
+        vector<int> starts;
+    };
+    vector<Candidate> candidates, survivors;
+
+    for (int k = 0; k < count; k++) {
+        const unsigned char* in = postings[terms[k]].bytes;
+        const unsigned char* end = in + postings[terms[k]].size;
+        int unit = 0;
+        size_t c = 0;
+        vector<int> positions;
+        survivors.clear();
+
+        while (in < end) {
+            unit += (int)readVarint(in);
+            int tf = (int)readVarint(in);
+            positions.clear();
+            int position = 0;
+            for (int j = 0; j < tf; j++) {
+                position += (int)readVarint(in);
+                positions.push_back(position);
+            }
+            if (!unitAlive[unit]) continue;
+
+            if (k == 0) {
+                Candidate fresh;
+                fresh.unit = unit;
+                fresh.starts = positions;
+                survivors.push_back(fresh);
+                continue;
+            }
+            // Both sequences are in unit order: merge
+            while (c < candidates.size() && candidates[c].unit < unit) c++;
+            if (c == candidates.size()) break;
+            if (candidates[c].unit != unit) continue;
+
+            Candidate kept;
+            kept.unit = unit;
+            for (int start : candidates[c].starts) {
+                if (binary_search(positions.begin(), positions.end(), start + k)) kept.starts.push_back(start);
+            }
+            if (!kept.starts.empty()) survivors.push_back(kept);
+        }
+        candidates.swap(survivors);
+        if (candidates.empty()) return;
+    }
+
+    double phraseIdf = 0;
+    for (int k = 0; k < count; k++) phraseIdf += idf(terms[k]);
+    double averageLength = liveUnits > 0 ? (double)liveLength / liveUnits : 1.0;
+    for (const Candidate& candidate : candidates) {
+        Post* post = unitPost[candidate.unit];
+        Hit hit = { post->postID,
+                    bm25((double)candidate.starts.size(), phraseIdf, unitLength[candidate.unit], averageLength),
+                    post };
+        hits.push_back(hit);
+    }
+    collapseByPost(hits);
+}
+
+// Parsed query: groups are ANDed; the clauses inside one group are ORed
+struct QueryClause {
+    vector<string> words;   // More than one = phrase
+};
+
+struct QueryGroup {
+    vector<QueryClause> clauses;
+    bool negated;
+};
+
+static void parseQuery(const string& query, vector<QueryGroup>& groups) {
+    groups.clear();
+    bool pendingOr = false;
+    size_t i = 0;
+    vector<string> words;
+
+    while (i < query.size()) {
+        while (i < query.size() && isspace((unsigned char)query[i])) i++;
+        if (i >= query.size()) break;
+
+        bool negated = false;
+        if (query[i] == '-' && i + 1 < query.size() && !isspace((unsigned char)query[i + 1])) {
+            negated = true;
+            i++;
+        }
+
+        string text;
+        if (query[i] == '"') {
+            size_t close = query.find('"', i + 1);
+            if (close == string::npos) close = query.size();
+            text = query.substr(i + 1, close - i - 1);
+            i = close + 1;
+        } else {
+            size_t start = i;
+            while (i < query.size() && !isspace((unsigned char)query[i])) i++;
+            text = query.substr(start, i - start);
+            if (text == "OR" && !negated) {
+                pendingOr = !groups.empty();
+                continue;
+            }
+        }
+
+        // "e-mail" tokenizes to two words and is treated as a phrase
+        tokenize(text, words);
+        if (words.empty()) {
+            pendingOr = false;
+            continue;
+        }
+        QueryClause clause;
+        clause.words = words;
+
+        if (pendingOr && !negated && !groups.back().negated) {
+            groups.back().clauses.push_back(clause);
+        } else {
+            QueryGroup group;
+            group.clauses.push_back(clause);
+            group.negated = negated;
+            groups.push_back(group);
+        }
+        pendingOr = false;
+    }
+}
+
+int PostSearchIndex::search(const string& query, Post** results, int maxResults) {
+    if (maxResults <= 0 || liveUnits == 0) return 0;
+
+    vector<QueryGroup> groups;
+    parseQuery(query, groups);
+
+    vector<Hit> result, groupHits, clauseHits, merged;
+    bool haveResult = false;
+    vector<int> terms;
+
+    // Positive groups first, so exclusions have something to subtract from
+    for (int pass = 0; pass < 2; pass++) {
+        for (const QueryGroup& group : groups) {
+            if (group.negated != (pass == 1)) continue;
+
+            groupHits.clear();
+            for (const QueryClause& clause : group.clauses) {
+                terms.clear();
+                for (const string& word : clause.words) {
+                    int term = findTerm(word, false);
+                    if (term < 0) break;
+                    terms.push_back(term);
+                }
+                if (terms.size() != clause.words.size()) continue; // Unknown word: no hits
+                if (terms.size() == 1) termHits(terms[0], clauseHits);
+                else phraseHits(terms.data(), (int)terms.size(), clauseHits);
+
+                // OR: union, summing scores of posts in both
+                groupHits.insert(groupHits.end(), clauseHits.begin(), clauseHits.end());
+                collapseByPost(groupHits);
+            }
+
+            if (pass == 1) {
+                // NOT: drop posts present in groupHits
+                merged.clear();
+                size_t g = 0;
+                for (const Hit& hit : result) {
+                    while (g < groupHits.size() && groupHits[g].postID < hit.postID) g++;
+                    if (g == groupHits.size() || groupHits[g].postID != hit.postID) merged.push_back(hit);
+                }
+                result.swap(merged);
+            } else if (!haveResult) {
+                result = groupHits;
+                haveResult = true;
+            } else {
+                // AND: intersection, summing scores
+                merged.clear();
+                size_t g = 0;
+                for (const Hit& hit : result) {
+                    while (g < groupHits.size() && groupHits[g].postID < hit.postID) g++;
+                    if (g < groupHits.size() && groupHits[g].postID == hit.postID) {
+                        Hit both = hit;
+                        both.score += groupHits[g].score;
+                        merged.push_back(both);
+                    }
+                }
+                result.swap(merged);
+            }
+        }
+        if (!haveResult) return 0; // Only exclusions, or nothing at all
+    }
+
+    int count = min(maxResults, (int)result.size());
+    partial_sort(result.begin(), result.begin() + count, result.end(), [](const Hit& a, const Hit& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.postID > b.postID;
+    });
+    for (int i = 0; i < count; i++) {
+        results[i] = result[i].post;
+    }
+    return count;
+}
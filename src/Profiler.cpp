@@ -0,0 +1,137 @@
+#include "../include/Core.h"
+#include <thread>
+
+// ==================== PROFILER ====================
+atomic<bool> Profiler::enabled(false);
+mutex Profiler::lock;
+Profiler::Zone Profiler::zones[Profiler::MAX_ZONES];
+int Profiler::zoneCount = 0;
+Profiler::TraceEvent* Profiler::trace = nullptr;
+int Profiler::traceCount = 0;
+int Profiler::traceDropped = 0;
+bool Profiler::capturing = false;
+chrono::steady_clock::time_point Profiler::epoch = chrono::steady_clock::now();
+
+// Small stable per-thread number for the trace's "tid" column
+static int threadIndex() {
+    static atomic<int> nextThread(1);
+    thread_local int index = nextThread.fetch_add(1);
+    return index;
+}
+
+void Profiler::setEnabled(bool on) {
+    enabled.store(on, memory_order_relaxed);
+}
+
+void Profiler::record(const char* name, chrono::steady_clock::time_point start,
+                      chrono::steady_clock::time_point end) {
+    double ms = chrono::duration<double, milli>(end - start).count();
+    lock_guard<mutex> guard(lock);
+
+    // Zones are few; pointer compare catches the common case of one literal
+    int z = 0;
+    while (z < zoneCount && zones[z].name != name && strcmp(zones[z].name, name) != 0) z++;
+    if (z == zoneCount) {
+        if (zoneCount == MAX_ZONES) return;
+        zones[z].name = name;
+        zones[z].next = 0;
+        zones[z].count = 0;
+        zoneCount++;
+    }
+
+    Zone& zone = zones[z];
+    zone.samples[zone.next] = ms;
+    zone.next = (zone.next + 1) % ZONE_SAMPLES;
+    if (zone.count < ZONE_SAMPLES) zone.count++;
+
+    if (capturing) {
+        if (traceCount < MAX_TRACE_EVENTS) {
+            TraceEvent& event = trace[traceCount++];
+            event.name = name;
+            event.startUs = chrono::duration<double, micro>(start - epoch).count();
+            event.durationUs = ms * 1000.0;
+            event.thread = threadIndex();
+        } else {
+            traceDropped++;
+        }
+    }
+}
+
+int Profiler::getStats(ProfileStats* out, int maxZones) {
+    lock_guard<mutex> guard(lock);
+
+    double sorted[ZONE_SAMPLES];
+    int count = 0;
+    for (int z = 0; z < zoneCount && count < maxZones; z++) {
+        Zone& zone = zones[z];
+        if (zone.count == 0) continue;
+
+        memcpy(sorted, zone.samples, zone.count * sizeof(double));
+        sort(sorted, sorted + zone.count);
+
+        ProfileStats& stats = out[count++];
+        stats.name = zone.name;
+        stats.count = zone.count;
+        stats.p50Ms = sorted[(zone.count - 1) / 2];
+        stats.p99Ms = sorted[(zone.count * 99 + 99) / 100 - 1]; // Nearest rank
+        stats.maxMs = sorted[zone.count - 1];
+    }
+    return count;
+}
+
+void Profiler::reset() {
+    lock_guard<mutex> guard(lock);
+    for (int z = 0; z < zoneCount; z++) {
+        zones[z].next = 0;
+        zones[z].count = 0;
+    }
+}
+
+// ==================== TRACE CAPTURE ====================
+void Profiler::startCapture() {
+    lock_guard<mutex> guard(lock);
+    if (!trace) trace = new TraceEvent[MAX_TRACE_EVENTS];
+    traceCount = 0;
+    traceDropped = 0;
+    capturing = true;
+}
+
+bool Profiler::isCapturing() {
+    lock_guard<mutex> guard(lock);
+    return capturing;
+}
+
+int Profiler::getCaptureCount() {
+    lock_guard<mutex> guard(lock);
+    return traceCount;
+}
+
+bool Profiler::writeTrace(const string& filename) {
+    lock_guard<mutex> guard(lock);
+    capturing = false;
+
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << filename << " for writing" << endl;
+        return false;
+    }
+
+    // Chrome trace event format: complete ("X") events, times in microseconds
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    char buffer[256];
+    for (int i = 0; i < traceCount; i++) {
+        const TraceEvent& event = trace[i];
+        snprintf(buffer, sizeof(buffer),
+                 "{\"name\": \"%s\", \"cat\": \"app\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d}%s\n",
+                 event.name, event.startUs, event.durationUs, event.thread,
+                 i + 1 < traceCount ? "," : "");
+        file << buffer;
+    }
+    file << "]}\n";
+    file.close();
+
+    cout << "Wrote " << traceCount << " trace events to " << filename;
+    if (traceDropped > 0) cout << " (" << traceDropped << " dropped)";
+    cout << endl;
+    return true;
+}
@@ -0,0 +1,169 @@
+#include "../include/Core.h"
+
+// ==================== WHO TO FOLLOW ====================
+FollowRecommender::FollowRecommender()
+    : capacity(0), workersReady(0), followees(nullptr), followeesCapacity(0),
+      influence(nullptr), influenceSlots(0) {
+    for (int w = 0; w < MAX_WORKERS; w++) {
+        scratch[w].counts = nullptr;
+        scratch[w].touched = nullptr;
+        scratch[w].touchedCount = 0;
+    }
+}
+
+FollowRecommender::~FollowRecommender() {
+    for (int w = 0; w < MAX_WORKERS; w++) {
+        delete[] scratch[w].counts;
+        delete[] scratch[w].touched;
+    }
+    delete[] followees;
+    delete[] influence;
+}
+
+void FollowRecommender::setInfluence(const float* scores, int slots) {
+    delete[] influence;
+    influence = new float[slots];
+    memcpy(influence, scores, slots * sizeof(float));
+    influenceSlots = slots;
+}
+
+void FollowRecommender::ensureCapacity(int slots, int workers) {
+    if (slots > capacity) {
+        // Room for the users registered after this, so they don't force a
+        // reallocation each
+        for (int w = 0; w < workersReady; w++) {
+            delete[] scratch[w].counts;
+            delete[] scratch[w].touched;
+            scratch[w].counts = nullptr;
+            scratch[w].touched = nullptr;
+        }
+        capacity = slots + slots / 4 + 1024;
+        workersReady = 0;
+    }
+    while (workersReady < workers) {
+        Scratch& s = scratch[workersReady++];
+        s.counts = new int[capacity]();
+        s.touched = new int[capacity];
+        s.touchedCount = 0;
+    }
+}
+
+void FollowRecommender::countRange(Scratch* s, User** list, int begin, int end, int slots) {
+    int* counts = s->counts;
+    int* touched = s->touched;
+    int touchedCount = s->touchedCount;
+    for (int i = begin; i < end; i++) {
+        const int* following = list[i]->followingList;
+        int count = list[i]->followingCount;
+        for (int j = 0; j < count; j++) {
+            int slot = following[j] - FIRST_USER_ID;
+            if ((unsigned)slot >= (unsigned)slots) continue;
+            if (counts[slot]++ == 0) touched[touchedCount++] = slot;
+        }
+    }
+    s->touchedCount = touchedCount;
+}
+
+int FollowRecommender::recommend(UserDatabase* users, User* user, User** results, int* connections, int maxResults) {
+    if (!user || maxResults <= 0) return 0;
+    int slots = users->getNextUserID() - FIRST_USER_ID;
+    if (slots <= 0) return 0;
+
+    // Resolve the accounts this user follows
+    if (user->followingCount > followeesCapacity) {
+        delete[] followees;
+        followeesCapacity = user->followingCount * 2;
+        followees = new User*[followeesCapacity];
+    }
+    int followeeCount = 0;
+    long long edges = 0;
+    for (int i = 0; i < user->followingCount; i++) {
+        User* followee = users->searchByID(user->followingList[i]);
+        if (!followee) continue;
+        followees[followeeCount++] = followee;
+        edges += followee->followingCount;
+    }
+
+    int workers = 1;
+    if (edges >= PARALLEL_EDGES) {
+        workers = (int)min((long long)edges / PARALLEL_EDGES + 1, (long long)MAX_WORKERS);
+        workers = min(workers, (int)max(thread::hardware_concurrency(), 1u));
+        workers = min(workers, followeeCount);
+    }
+    ensureCapacity(slots, workers);
+
+    if (workers == 1) {
+        countRange(&scratch[0], followees, 0, followeeCount, slots);
+    } else {
+        // Contiguous runs of followees with about the same number of edges
+        int bounds[MAX_WORKERS + 1];
+        bounds[0] = 0;
+        long long seen = 0;
+        int next = 1;
+        for (int i = 0; i < followeeCount && next < workers; i++) {
+            seen += followees[i]->followingCount;
+            if (seen * workers >= edges * next) bounds[next++] = i + 1;
+        }
+        while (next <= workers) bounds[next++] = followeeCount;
+
+        thread pool[MAX_WORKERS];
+        for (int w = 1; w < workers; w++) {
+            pool[w] = thread(countRange, &scratch[w], followees, bounds[w], bounds[w + 1], slots);
+        }
+        countRange(&scratch[0], followees, bounds[0], bounds[1], slots);
+        for (int w = 1; w < workers; w++) pool[w].join();
+
+        // Fold the other workers into the first, clearing them as we go
+        Scratch& total = scratch[0];
+        for (int w = 1; w < workers; w++) {
+            Scratch& part = scratch[w];
+            for (int i = 0; i < part.touchedCount; i++) {
+                int slot = part.touched[i];
+                if (total.counts[slot] == 0) total.touched[total.touchedCount++] = slot;
+                total.counts[slot] += part.counts[slot];
+                part.counts[slot] = 0;
+            }
+            part.touchedCount = 0;
+        }
+    }
+
+    // Already followed, or the user: not suggestions
+    Scratch& total = scratch[0];
+    int self = user->userID - FIRST_USER_ID;
+    if ((unsigned)self < (unsigned)slots) total.counts[self] = 0;
+    for (int i = 0; i < user->followingCount; i++) {
+        int slot = user->followingList[i] - FIRST_USER_ID;
+        if ((unsigned)slot < (unsigned)slots) total.counts[slot] = 0;
+    }
+
+    // Drop the excluded slots (already zero) and pick the best
+    int* counts = total.counts;
+    const float* scores = influence;
+    int scored = influenceSlots;
+    int candidates = 0;
+    for (int i = 0; i < total.touchedCount; i++) {
+        if (counts[total.touched[i]] > 0) total.touched[candidates++] = total.touched[i];
+    }
+    int shown = min(candidates, maxResults);
+    partial_sort(total.touched, total.touched + shown, total.touched + candidates,
+                 [counts, scores, scored](int a, int b) {
+        if (counts[a] != counts[b]) return counts[a] > counts[b];
+        float influenceA = a < scored ? scores[a] : 0.0f;
+        float influenceB = b < scored ? scores[b] : 0.0f;
+        if (influenceA != influenceB) return influenceA > influenceB;
+        return a < b;
+    });
+
+    int found = 0;
+    for (int i = 0; i < shown; i++) {
+        User* suggestion = users->searchByID(total.touched[i] + FIRST_USER_ID);
+        if (!suggestion) continue;
+        results[found] = suggestion;
+        if (connections) connections[found] = counts[total.touched[i]];
+        found++;
+    }
+
+    for (int i = 0; i < candidates; i++) counts[total.touched[i]] = 0;
+    total.touchedCount = 0;
+    return found;
+}
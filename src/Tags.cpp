@@ -0,0 +1,181 @@
+#include "../include/Core.h"
+
+// ==================== HASHTAGS AND MENTIONS ====================
+static inline bool isTagByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+static void addUnique(vector<string>& list, const string& value) {
+    for (const string& existing : list) {
+        if (existing == value) return;
+    }
+    list.push_back(value);
+}
+
+void extractTags(const string& text, vector<string>& hashtags, vector<string>& mentions) {
+    hashtags.clear();
+    mentions.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        char marker = text[i];
+        bool wordStart = i == 0 || !isTagByte((unsigned char)text[i - 1]);
+        if ((marker != '#' && marker != '@') || !wordStart) {
+            i++;
+            continue;
+        }
+
+        size_t start = ++i;
+        while (i < text.size() && isTagByte((unsigned char)text[i])) i++;
+        if (i == start) continue; // A lone marker
+
+        // Cut long tags on a UTF-8 character boundary
+        size_t length = i - start;
+        if (length > (size_t)MAX_TAG_LENGTH) {
+            length = MAX_TAG_LENGTH;
+            while (length > 0 && ((unsigned char)text[start + length] & 0xC0) == 0x80) length--;
+        }
+        string tag = text.substr(start, length);
+        if (marker == '#') {
+            for (char& c : tag) c = (char)tolower((unsigned char)c);
+            addUnique(hashtags, tag);
+        } else {
+            addUnique(mentions, tag);
+        }
+    }
+}
+
+// ==================== TAG INDEX ====================
+// Oldest first; posts created in the same second keep creation order
+static bool postEarlier(const Post* a, const Post* b) {
+    uint64_t ta = a->timestamp.packed(), tb = b->timestamp.packed();
+    if (ta != tb) return ta < tb;
+    return a->postID < b->postID;
+}
+
+TagIndex::TagIndex() : table(nullptr), tableSize(0), tableUsed(0) {
+    clear();
+}
+
+TagIndex::~TagIndex() {
+    for (int i = 0; i < tableSize; i++) {
+        delete[] table[i].posts;
+    }
+    delete[] table;
+}
+
+void TagIndex::clear() {
+    for (int i = 0; i < tableSize; i++) {
+        delete[] table[i].posts;
+    }
+    delete[] table;
+
+    tableSize = 256;
+    tableUsed = 0;
+    table = new Timeline[tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i].posts = nullptr;
+        table[i].count = 0;
+        table[i].capacity = 0;
+        table[i].sorted = true;
+    }
+}
+
+TagIndex::Timeline* TagIndex::find(const string& key, bool create) {
+    int mask = tableSize - 1;
+    int index = (int)(fnv1a(key) & (uint32_t)mask);
+    while (table[index].posts) {
+        if (table[index].key == key) return &table[index];
+        index = (index + 1) & mask;
+    }
+    if (!create) return nullptr;
+
+    // Keep the table at most half full
+    if ((tableUsed + 1) * 2 > tableSize) {
+        grow();
+        return find(key, true);
+    }
+    Timeline& timeline = table[index];
+    timeline.key = key;
+    timeline.capacity = 4;
+    timeline.posts = new Post*[timeline.capacity];
+    timeline.count = 0;
+    timeline.sorted = true;
+    tableUsed++;
+    return &timeline;
+}
+
+void TagIndex::grow() {
+    Timeline* oldTable = table;
+    int oldSize = tableSize;
+
+    tableSize *= 2;
+    table = new Timeline[tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i].posts = nullptr;
+        table[i].count = 0;
+        table[i].capacity = 0;
+        table[i].sorted = true;
+    }
+
+    int mask = tableSize - 1;
+    for (int i = 0; i < oldSize; i++) {
+        if (!oldTable[i].posts) continue;
+        int index = (int)(fnv1a(oldTable[i].key) & (uint32_t)mask);
+        while (table[index].posts) {
+            index = (index + 1) & mask;
+        }
+        table[index].key.swap(oldTable[i].key);
+        table[index].posts = oldTable[i].posts; // Moves the post array
+        table[index].count = oldTable[i].count;
+        table[index].capacity = oldTable[i].capacity;
+        table[index].sorted = oldTable[i].sorted;
+    }
+    delete[] oldTable;
+}
+
+void TagIndex::add(const string& key, Post* post) {
+    Timeline* timeline = find(key, true);
+    if (timeline->count == timeline->capacity) {
+        timeline->capacity *= 2;
+        Post** newPosts = new Post*[timeline->capacity];
+        memcpy(newPosts, timeline->posts, timeline->count * sizeof(Post*));
+        delete[] timeline->posts;
+        timeline->posts = newPosts;
+    }
+    if (timeline->count > 0 && postEarlier(post, timeline->posts[timeline->count - 1])) {
+        timeline->sorted = false;
+    }
+    timeline->posts[timeline->count++] = post;
+}
+
+void TagIndex::remove(const string& key, Post* post) {
+    Timeline* timeline = find(key, false);
+    if (!timeline) return;
+    for (int i = 0; i < timeline->count; i++) {
+        if (timeline->posts[i] == post) {
+            // Shift down, keeping the order
+            memmove(timeline->posts + i, timeline->posts + i + 1, (timeline->count - i - 1) * sizeof(Post*));
+            timeline->count--;
+            return;
+        }
+    }
+}
+
+int TagIndex::get(const string& key, Post** results, int maxResults) {
+    Timeline* timeline = find(key, false);
+    if (!timeline) return 0;
+    if (!timeline->sorted) {
+        sort(timeline->posts, timeline->posts + timeline->count, postEarlier);
+        timeline->sorted = true;
+    }
+    int count = min(maxResults, timeline->count);
+    for (int i = 0; i < count; i++) {
+        results[i] = timeline->posts[timeline->count - 1 - i];
+    }
+    return count;
+}
+
+int TagIndex::getCount(const string& key) {
+    Timeline* timeline = find(key, false);
+    return timeline ? timeline->count : 0;
+}
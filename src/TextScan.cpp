@@ -0,0 +1,142 @@
+#include "../include/Core.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define TEXT_SCAN_SSE2 1
+#endif
+
+// AVX2 is compiled with a target attribute and picked at run time, so the
+// library itself still runs on any x86-64
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEXT_SCAN_AVX2 1
+#endif
+
+// ==================== CASELESS SUBSTRING SCAN ====================
+static inline unsigned char foldByte(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+static inline bool caselessEqual(const char* a, const char* b, int length) {
+    for (int i = 0; i < length; i++) {
+        if (foldByte((unsigned char)a[i]) != foldByte((unsigned char)b[i])) return false;
+    }
+    return true;
+}
+
+// Checks the candidates whose first byte is at or after `from`
+static int scalarFrom(const char* haystack, int length, const char* needle, int needleLength, int from) {
+    unsigned char first = foldByte((unsigned char)needle[0]);
+    for (int i = from; i + needleLength <= length; i++) {
+        if (foldByte((unsigned char)haystack[i]) == first &&
+            caselessEqual(haystack + i + 1, needle + 1, needleLength - 1)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int findCaselessScalar(const char* haystack, int length, const char* needle, int needleLength) {
+    if (needleLength <= 0) return 0;
+    return scalarFrom(haystack, length, needle, needleLength, 0);
+}
+
+// Vector kernels: compare a block of candidate starts against the needle's
+// first and last bytes at once (both folded), and only check the middle of
+// the candidates where both agree.
+
+#ifdef TEXT_SCAN_SSE2
+static inline __m128i fold16(__m128i x) {
+    // Signed compares: bytes >= 0x80 are negative and never fold
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+static int findCaselessSSE2(const char* haystack, int length, const char* needle, int needleLength) {
+    const __m128i first = _mm_set1_epi8((char)foldByte((unsigned char)needle[0]));
+    const __m128i last = _mm_set1_epi8((char)foldByte((unsigned char)needle[needleLength - 1]));
+    int i = 0;
+    for (; i + needleLength - 1 + 16 <= length; i += 16) {
+        __m128i blockFirst = fold16(_mm_loadu_si128((const __m128i*)(haystack + i)));
+        __m128i blockLast = fold16(_mm_loadu_si128((const __m128i*)(haystack + i + needleLength - 1)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                                                  _mm_cmpeq_epi8(blockLast, last)));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (needleLength <= 2 || caselessEqual(haystack + i + bit + 1, needle + 1, needleLength - 2)) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scalarFrom(haystack, length, needle, needleLength, i);
+}
+#endif
+
+#ifdef TEXT_SCAN_AVX2
+__attribute__((target("avx2")))
+static inline __m256i fold32(__m256i x) {
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x));
+    return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+static int findCaselessAVX2(const char* haystack, int length, const char* needle, int needleLength) {
+    const __m256i first = _mm256_set1_epi8((char)foldByte((unsigned char)needle[0]));
+    const __m256i last = _mm256_set1_epi8((char)foldByte((unsigned char)needle[needleLength - 1]));
+    int i = 0;
+    for (; i + needleLength - 1 + 32 <= length; i += 32) {
+        __m256i blockFirst = fold32(_mm256_loadu_si256((const __m256i*)(haystack + i)));
+        __m256i blockLast = fold32(_mm256_loadu_si256((const __m256i*)(haystack + i + needleLength - 1)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first),
+                                                                        _mm256_cmpeq_epi8(blockLast, last)));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (needleLength <= 2 || caselessEqual(haystack + i + bit + 1, needle + 1, needleLength - 2)) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scalarFrom(haystack, length, needle, needleLength, i);
+}
+#endif
+
+typedef int (*FindKernel)(const char*, int, const char*, int);
+
+static FindKernel chooseKernel(const char** name) {
+#ifdef TEXT_SCAN_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return findCaselessAVX2;
+    }
+#endif
+#ifdef TEXT_SCAN_SSE2
+    *name = "sse2";
+    return findCaselessSSE2;
+#else
+    *name = "scalar";
+    return findCaselessScalar;
+#endif
+}
+
+static const char* kernelName = "scalar";
+
+// Resolved on first use, so callers during static initialization are safe
+static FindKernel getKernel() {
+    static const FindKernel kernel = chooseKernel(&kernelName);
+    return kernel;
+}
+
+int findCaseless(const char* haystack, int length, const char* needle, int needleLength) {
+    if (needleLength <= 0) return 0;
+    if (needleLength > length) return -1;
+    return getKernel()(haystack, length, needle, needleLength);
+}
+
+const char* caselessKernelName() {
+    getKernel();
+    return kernelName;
+}
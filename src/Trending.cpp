@@ -0,0 +1,177 @@
+#include "../include/Core.h"
+#include <cmath>
+
+// ==================== DECAYED TOP-K ====================
+// Rescale once the forward-decay factor passes e^40 (about 4.8 days at a
+// two-hour half-life), long before doubles lose precision
+static const double RESCALE_EXPONENT = 40.0;
+
+// Scores below this (one event about nine half-lives ago) are not trending
+static const double MIN_TRENDING_SCORE = 0.002;
+
+static inline uint64_t mixKey(uint64_t x) {
+    // splitmix64 finalizer
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+DecayedTopK::DecayedTopK(double halfLifeSeconds)
+    : heapSize(0), rate(log(2.0) / halfLifeSeconds), landmark(time(0)) {
+    sketch = new double[DEPTH * WIDTH];
+    clear();
+}
+
+DecayedTopK::~DecayedTopK() {
+    delete[] sketch;
+}
+
+void DecayedTopK::clear() {
+    for (int i = 0; i < DEPTH * WIDTH; i++) sketch[i] = 0.0;
+    for (int i = 0; i < heapSize; i++) heap[i].label.clear();
+    heapSize = 0;
+    landmark = time(0);
+}
+
+int DecayedTopK::findEntry(uint64_t key) {
+    for (int i = 0; i < heapSize; i++) {
+        if (heap[i].key == key) return i;
+    }
+    return -1;
+}
+
+void DecayedTopK::siftDown(int index) {
+    while (true) {
+        int smallest = index;
+        int left = 2 * index + 1, right = left + 1;
+        if (left < heapSize && heap[left].count < heap[smallest].count) smallest = left;
+        if (right < heapSize && heap[right].count < heap[smallest].count) smallest = right;
+        if (smallest == index) return;
+        swap(heap[index], heap[smallest]);
+        index = smallest;
+    }
+}
+
+void DecayedTopK::siftUp(int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (heap[parent].count <= heap[index].count) return;
+        swap(heap[index], heap[parent]);
+        index = parent;
+    }
+}
+
+void DecayedTopK::rescale(time_t when) {
+    double factor = exp(-rate * (double)(when - landmark));
+    for (int i = 0; i < DEPTH * WIDTH; i++) sketch[i] *= factor;
+    for (int i = 0; i < heapSize; i++) heap[i].count *= factor;
+    landmark = when;
+}
+
+void DecayedTopK::add(uint64_t key, const string& label, Post* post, double weight, time_t when) {
+    double exponent = rate * (double)(when - landmark);
+    if (exponent > RESCALE_EXPONENT) {
+        rescale(when);
+        exponent = 0.0;
+    }
+    double scaled = weight * exp(exponent);
+
+    // Conservative update: raise each row only as far as the new minimum,
+    // which keeps collisions from inflating the estimate as much
+    uint64_t hash = mixKey(key);
+    uint32_t h1 = (uint32_t)hash, h2 = (uint32_t)(hash >> 32) | 1u;
+    double* cells[DEPTH];
+    double estimate = 0.0;
+    for (int d = 0; d < DEPTH; d++) {
+        cells[d] = sketch + d * WIDTH + ((h1 + (uint32_t)d * h2) & (WIDTH - 1));
+        if (d == 0 || *cells[d] < estimate) estimate = *cells[d];
+    }
+    double updated = estimate + scaled;
+    for (int d = 0; d < DEPTH; d++) {
+        if (*cells[d] < updated) *cells[d] = updated;
+    }
+
+    int index = findEntry(key);
+    if (index >= 0) {
+        heap[index].count = updated;
+        siftDown(index);
+    } else if (heapSize < K) {
+        heap[heapSize].key = key;
+        heap[heapSize].label = label;
+        heap[heapSize].post = post;
+        heap[heapSize].count = updated;
+        siftUp(heapSize++);
+    } else if (updated > heap[0].count) {
+        heap[0].key = key;
+        heap[0].label = label;
+        heap[0].post = post;
+        heap[0].count = updated;
+        siftDown(0);
+    }
+}
+
+void DecayedTopK::remove(uint64_t key) {
+    int index = findEntry(key);
+    if (index < 0) return;
+    heapSize--;
+    if (index < heapSize) {
+        heap[index] = heap[heapSize];
+        siftDown(index);
+        siftUp(index);
+    }
+}
+
+int DecayedTopK::top(Entry* out, int maxResults, time_t now) {
+    int count = min(maxResults, heapSize);
+    Entry* sorted = new Entry[heapSize];
+    for (int i = 0; i < heapSize; i++) sorted[i] = heap[i];
+    partial_sort(sorted, sorted + count, sorted + heapSize, [](const Entry& a, const Entry& b) {
+        return a.count > b.count;
+    });
+    double decay = exp(-rate * (double)(now - landmark));
+    for (int i = 0; i < count; i++) {
+        out[i] = sorted[i];
+        out[i].count *= decay;
+    }
+    delete[] sorted;
+    return count;
+}
+
+// ==================== TRENDING TRACKER ====================
+void TrendingTracker::recordTag(const string& tag, double weight, time_t when) {
+    tags.add(fnv1a64(tag), tag, nullptr, weight, when);
+}
+
+void TrendingTracker::recordPost(Post* post, double weight, time_t when) {
+    posts.add((uint64_t)post->postID, "", post, weight, when);
+}
+
+int TrendingTracker::topTags(string* tagsOut, double* scores, int maxResults, time_t now) {
+    DecayedTopK::Entry entries[DecayedTopK::K];
+    int count = tags.top(entries, min(maxResults, (int)DecayedTopK::K), now);
+    int kept = 0;
+    while (kept < count && entries[kept].count >= MIN_TRENDING_SCORE) {
+        tagsOut[kept] = entries[kept].label;
+        if (scores) scores[kept] = entries[kept].count;
+        kept++;
+    }
+    return kept;
+}
+
+int TrendingTracker::topPosts(Post** postsOut, double* scores, int maxResults, time_t now) {
+    DecayedTopK::Entry entries[DecayedTopK::K];
+    int count = posts.top(entries, min(maxResults, (int)DecayedTopK::K), now);
+    int kept = 0;
+    while (kept < count && entries[kept].count >= MIN_TRENDING_SCORE) {
+        postsOut[kept] = entries[kept].post;
+        if (scores) scores[kept] = entries[kept].count;
+        kept++;
+    }
+    return kept;
+}
+
+void TrendingTracker::clear() {
+    tags.clear();
+    posts.clear();
+}
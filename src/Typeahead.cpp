@@ -0,0 +1,109 @@
+#include "../include/Core.h"
+
+// ==================== TYPEAHEAD SEARCH ====================
+TypeaheadSearch::TypeaheadSearch(UserDatabase* userDB, int debounce)
+    : users(userDB), debounceMs(debounce), stopping(false), hasPending(false),
+      pendingImmediate(false), resultCount(0), resultVersion(0),
+      cacheCount(0), cacheComplete(false) {
+    cache = new User*[CACHE_RESULTS];
+    worker = thread(&TypeaheadSearch::run, this);
+}
+
+TypeaheadSearch::~TypeaheadSearch() {
+    {
+        lock_guard<mutex> state(stateLock);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    delete[] cache;
+}
+
+void TypeaheadSearch::setQuery(const string& query, bool immediate) {
+    {
+        lock_guard<mutex> state(stateLock);
+        pendingQuery = query;
+        pendingSince = chrono::steady_clock::now();
+        pendingImmediate = pendingImmediate || immediate;
+        hasPending = true;
+    }
+    wake.notify_one();
+}
+
+bool TypeaheadSearch::poll(int& version, User** out, int& count) {
+    lock_guard<mutex> state(stateLock);
+    if (version == resultVersion) return false;
+    memcpy(out, results, resultCount * sizeof(User*));
+    count = resultCount;
+    version = resultVersion;
+    return true;
+}
+
+void TypeaheadSearch::run() {
+    unique_lock<mutex> state(stateLock);
+    while (true) {
+        wake.wait(state, [this] { return stopping || hasPending; });
+        if (stopping) return;
+
+        // Debounce: every keystroke moves pendingSince and restarts the wait
+        while (!stopping && !pendingImmediate &&
+               chrono::steady_clock::now() < pendingSince + chrono::milliseconds(debounceMs)) {
+            wake.wait_until(state, pendingSince + chrono::milliseconds(debounceMs));
+        }
+        if (stopping) return;
+
+        string query = pendingQuery;
+        hasPending = false;
+        pendingImmediate = false;
+        state.unlock();
+
+        User* found[MAX_RESULTS];
+        int count;
+        {
+            lock_guard<mutex> data(dataLock);
+            count = search(query, found);
+        }
+
+        // Published even if a newer query is pending; it replaces these soon
+        state.lock();
+        memcpy(results, found, count * sizeof(User*));
+        resultCount = count;
+        resultVersion++;
+        state.unlock();
+        ChangeSignal::raise();
+        state.lock();
+    }
+}
+
+int TypeaheadSearch::search(const string& query, User** found) {
+    if (query.empty()) {
+        cacheQuery.clear();
+        cacheCount = 0;
+        cacheComplete = false;
+        return 0;
+    }
+
+    bool narrowing = cacheComplete && !cacheQuery.empty() &&
+                     findCaseless(query.data(), (int)query.size(), cacheQuery.data(), (int)cacheQuery.size()) >= 0;
+    if (narrowing) {
+        int kept = 0;
+        for (int i = 0; i < cacheCount; i++) {
+            const string& name = cache[i]->username;
+            if (findCaseless(name.data(), (int)name.size(), query.data(), (int)query.size()) >= 0) {
+                cache[kept++] = cache[i];
+            }
+        }
+        cacheCount = kept;
+        // Same order searchUsers() gives, in case follows changed meanwhile
+        stable_sort(cache, cache + cacheCount, rankedAbove);
+        Metrics::typeaheadNarrowed.add();
+    } else {
+        cacheCount = users->searchUsers(query, cache, CACHE_RESULTS);
+        cacheComplete = cacheCount < CACHE_RESULTS;
+    }
+    cacheQuery = query;
+
+    int count = min(cacheCount, (int)MAX_RESULTS);
+    memcpy(found, cache, count * sizeof(User*));
+    return count;
+}
@@ -1,4 +1,16 @@
 #include "App.h"
+#include <cmath>
+
+// List cards: chrome is a card's height besides its wrapped text, a first
+// guess that RowLayout corrects from the drawn rows. User cards hold one
+// line each and keep a fixed pitch.
+static const float FEED_CARD_CHROME = 132.0f;
+static const float PROFILE_CARD_CHROME = 88.0f;
+static const float POST_RESULT_CARD_CHROME = 71.0f;
+static const float COMMENT_CARD_CHROME = 62.0f;
+static const float SEARCH_CARD_HEIGHT = 80.0f;
+static const float CARD_PADDING = 10.0f;    // Above and below card contents
+static const float CARD_GAP = 15.0f;
 
 // ==================== UI CLASS ====================
 UI::UI(UserDatabase* users, PostDatabase* posts, NotificationQueue* notifs, History* hist)
@@ -11,7 +23,27 @@ UI::UI(UserDatabase* users, PostDatabase* posts, NotificationQueue* notifs, Hist
       notifications(notifs),
       history(hist),
       showError(false),
-      searchResultCount(0) {
+      searchResultCount(0),
+      typeaheadVersion(0),
+      searchPostsMode(false),
+      postResultCount(0),
+      postResultsVersion(-1),
+      trendingTagCount(0),
+      suggestionCount(0),
+      suggestionsUserID(0),
+      suggestionsFollowVersion(-1),
+      connectionsKey{0, 0, -1},
+      profilePostsUserID(0),
+      profilePostsVersion(-1),
+      commentRowsPostID(0),
+      commentRowsCount(-1),
+      feedLayout(FEED_CARD_CHROME, CARD_GAP),
+      profileLayout(PROFILE_CARD_CHROME, CARD_GAP),
+      postResultsLayout(POST_RESULT_CARD_CHROME, CARD_GAP),
+      commentLayout(COMMENT_CARD_CHROME, CARD_GAP),
+      renderCachesVersion(-1),
+      nowMinute(0),
+      showProfiler(false) {
 
     // Initialize input buffers
     memset(usernameInput, 0, sizeof(usernameInput));
@@ -23,9 +55,12 @@ UI::UI(UserDatabase* users, PostDatabase* posts, NotificationQueue* notifs, Hist
     memset(errorMessage, 0, sizeof(errorMessage));
 
     feed = new Feed();
+    typeahead = new TypeaheadSearch(users);
+    notificationRows.resize(notifs->getInboxLimit());
 }
 
 UI::~UI() {
+    delete typeahead;
     delete feed;
 }
 
@@ -33,8 +68,88 @@ Timestamp UI::getCurrentTime() {
     return getCurrentTimestamp();
 }
 
-std::string UI::timestampToString(const Timestamp& ts) {
-    return ::timestampToString(ts);
+// ==================== RENDER CACHE ====================
+RenderCache& UI::postCache(const Post* post) {
+    return postCaches[post->postID];
+}
+
+// Comment IDs count up within their post
+RenderCache& UI::commentCache(const Post* post, const Comment* comment) {
+    return commentCaches[((long long)post->postID << 32) | (unsigned)comment->commentID];
+}
+
+RenderCache& UI::notificationCache(const Notification* notification) {
+    return notificationCaches[notification->notificationID];
+}
+
+// Absolute time is formatted once per item; the relative part is refreshed
+// at most once per wall-clock minute.
+const char* UI::timeLabel(RenderCache& cache, const Timestamp& ts) {
+    if (!cache.valid) {
+        snprintf(cache.timestamp, sizeof(cache.timestamp), "%04d-%02d-%02d %02d:%02d:%02d",
+                 ts.year, ts.month, ts.day, ts.hour, ts.minute, ts.second);
+        cache.valid = true;
+    }
+    
+    if (cache.labelMinute != nowMinute) {
+        tm t = {};
+        t.tm_year = ts.year - 1900;
+        t.tm_mon = ts.month - 1;
+        t.tm_mday = ts.day;
+        t.tm_hour = ts.hour;
+        t.tm_min = ts.minute;
+        t.tm_sec = ts.second;
+        t.tm_isdst = -1;
+        long long minutes = nowMinute - (long long)mktime(&t) / 60;
+        
+        char relative[24];
+        if (minutes < 1) strcpy(relative, "just now");
+        else if (minutes < 60) snprintf(relative, sizeof(relative), "%lldm ago", minutes);
+        else if (minutes < 24 * 60) snprintf(relative, sizeof(relative), "%lldh ago", minutes / 60);
+        else snprintf(relative, sizeof(relative), "%lldd ago", minutes / (24 * 60));
+        
+        snprintf(cache.label, sizeof(cache.label), "%s  (%s)", cache.timestamp, relative);
+        cache.labelMinute = nowMinute;
+    }
+    return cache.label;
+}
+
+const char* UI::statsLabel(RenderCache& cache, int likes, int comments) {
+    if (cache.statsLikes != likes || cache.statsComments != comments) {
+        snprintf(cache.stats, sizeof(cache.stats), "Likes: %d  |  Comments: %d", likes, comments);
+        cache.statsLikes = likes;
+        cache.statsComments = comments;
+    }
+    return cache.stats;
+}
+
+// Wrapped text whose height is measured only when the wrap width changes;
+// the glyphs are drawn straight into the draw list, and only when visible.
+float UI::textHeight(const string& text, RenderCache& cache, float wrapWidth) {
+    if (cache.wrapWidth != wrapWidth) {
+        cache.wrappedHeight = ImGui::CalcTextSize(text.c_str(), text.c_str() + text.size(),
+                                                  false, wrapWidth).y;
+        cache.wrapWidth = wrapWidth;
+    }
+    return cache.wrappedHeight;
+}
+
+void UI::wrappedText(const string& text, RenderCache& cache, float wrapWidth) {
+    textHeight(text, cache, wrapWidth);
+    
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(wrapWidth, cache.wrappedHeight));
+    if (ImGui::IsItemVisible()) {
+        ImGui::GetWindowDrawList()->AddText(ImGui::GetFont(), ImGui::GetFontSize(), pos,
+                                            ImGui::GetColorU32(ImGuiCol_Text),
+                                            text.c_str(), text.c_str() + text.size(), wrapWidth);
+    }
+}
+
+static void ColoredLabel(const ImVec4& color, const char* text) {
+    ImGui::PushStyleColor(ImGuiCol_Text, color);
+    ImGui::TextUnformatted(text);
+    ImGui::PopStyleColor();
 }
 
 void UI::showErrorMessage(const char* msg) {
@@ -66,7 +181,86 @@ bool GradientButton(const char* label, const ImVec2& size) {
     return result;
 }
 
+// Pads a list row that started at rowY to exactly rowHeight
+static void EndFixedRow(float rowY, float rowHeight) {
+    ImGui::SetCursorPosY(rowY);
+    ImGui::Dummy(ImVec2(0, rowHeight - ImGui::GetStyle().ItemSpacing.y));
+}
+
+// ==================== ROW LAYOUT ====================
+RowLayout::RowLayout(float estimatedChrome, float rowGap)
+    : wrapWidth(-1.0f), chrome(estimatedChrome), measuredChrome(estimatedChrome), gap(rowGap), listTop(0.0f) {
+    offsets.push_back(0.0f);
+}
+
+void RowLayout::layout() {
+    offsets.resize(textHeights.size() + 1);
+    offsets[0] = 0.0f;
+    for (size_t i = 0; i < textHeights.size(); i++) {
+        offsets[i + 1] = offsets[i] + chrome + textHeights[i] + gap;
+    }
+}
+
+void RowLayout::clear(float width) {
+    textHeights.clear();
+    wrapWidth = width;
+    offsets.resize(1);
+}
+
+void RowLayout::add(float textHeight) {
+    textHeights.push_back(textHeight);
+    offsets.push_back(offsets.back() + chrome + textHeight + gap);
+}
+
+void RowLayout::begin(int& first, int& last) {
+    listTop = ImGui::GetCursorPosY();
+    measuredChrome = chrome;
+    float top = ImGui::GetScrollY() - listTop;
+    float bottom = top + ImGui::GetWindowHeight();
+    int count = size();
+    first = (int)(upper_bound(offsets.begin(), offsets.end(), top) - offsets.begin()) - 1;
+    first = min(max(first, 0), count);
+    last = (int)(lower_bound(offsets.begin(), offsets.end(), bottom) - offsets.begin());
+    last = max(min(last, count), first);
+}
+
+float RowLayout::beginRow(int row) {
+    ImGui::SetCursorPosY(listTop + offsets[row]);
+    return chrome + textHeights[row];
+}
+
+void RowLayout::endRow(int row, float bottomPadding) {
+    float contentHeight = ImGui::GetCursorPosY() - (listTop + offsets[row]);
+    measuredChrome = contentHeight + bottomPadding - textHeights[row];
+}
+
+void RowLayout::end() {
+    if (fabsf(measuredChrome - chrome) > 0.5f) {
+        // The cards drawn this frame didn't match their slots; redraw
+        chrome = measuredChrome;
+        layout();
+        ChangeSignal::raise();
+    }
+    if (textHeights.empty()) return;
+    ImGui::SetCursorPosY(listTop);
+    ImGui::Dummy(ImVec2(0, offsets.back() - ImGui::GetStyle().ItemSpacing.y));
+}
+
 void UI::render() {
+    // All user changes happen in here; keep the typeahead worker out
+    lock_guard<mutex> dataGuard(typeahead->getDataLock());
+    nowMinute = (long long)time(0) / 60;
+    if (renderCachesVersion != postDatabase->getVersion()) {
+        postCaches.clear();
+        commentCaches.clear();
+        renderCachesVersion = postDatabase->getVersion();
+    }
+    
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+        showProfiler = !showProfiler;
+        Profiler::setEnabled(showProfiler || Profiler::isCapturing());
+    }
+    
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
     
@@ -190,6 +384,22 @@ void UI::render() {
         if (ImGui::Button("N", ImVec2(iconSize, iconSize))) setScreen(NOTIFICATIONS_SCREEN);
         ImGui::PopStyleColor(3);
         
+        // Unread badge
+        int unread = notifications->getUnreadCount(currentUser->userID);
+        if (unread > 0) {
+            char badge[8];
+            if (unread > 9) strcpy(badge, "9+");
+            else snprintf(badge, sizeof(badge), "%d", unread);
+            
+            ImVec2 buttonMax = ImGui::GetItemRectMax();
+            ImVec2 buttonMin = ImGui::GetItemRectMin();
+            ImVec2 center = ImVec2(buttonMax.x - 2, buttonMin.y + 2);
+            ImVec2 textSize = ImGui::CalcTextSize(badge);
+            drawList->AddCircleFilled(center, 9.0f, IM_COL32(230, 60, 80, 255));
+            drawList->AddText(ImVec2(center.x - textSize.x / 2, center.y - textSize.y / 2),
+                              IM_COL32(255, 255, 255, 255), badge);
+        }
+        
         // Profile button
         ImGui::SameLine();
         ImGui::SetCursorPosX(buttonWidth * 4 + (buttonWidth - iconSize) / 2);
@@ -207,6 +417,61 @@ void UI::render() {
     ImGui::End();
     ImGui::PopStyleVar();
     ImGui::PopStyleColor();
+    
+    if (showProfiler) renderProfilerOverlay();
+}
+
+// ==================== PROFILER OVERLAY ====================
+void UI::renderProfilerOverlay() {
+    const float width = 420.0f;
+    ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - width - 10, 70), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(width, 0));
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    
+    if (!ImGui::Begin("Profiler", &showProfiler,
+                      ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize |
+                      ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing)) {
+        ImGui::End();
+        return;
+    }
+    
+    ImGui::TextDisabled("Rolling window per zone (F3 to hide)");
+    
+    ProfileStats stats[32];
+    int count = Profiler::getStats(stats, 32);
+    if (ImGui::BeginTable("zones", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch, 2.0f);
+        ImGui::TableSetupColumn("n");
+        ImGui::TableSetupColumn("p50 ms");
+        ImGui::TableSetupColumn("p99 ms");
+        ImGui::TableSetupColumn("max ms");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < count; i++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(stats[i].name);
+            ImGui::TableNextColumn(); ImGui::Text("%d", stats[i].count);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats[i].p50Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats[i].p99Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats[i].maxMs);
+        }
+        ImGui::EndTable();
+    }
+    
+    if (ImGui::Button("Reset")) Profiler::reset();
+    ImGui::SameLine();
+    if (Profiler::isCapturing()) {
+        if (ImGui::Button("Save trace")) {
+            Profiler::writeTrace("profile_trace.json");
+            Profiler::setEnabled(showProfiler);
+        }
+        ImGui::SameLine();
+        ImGui::Text("Capturing... %d events", Profiler::getCaptureCount());
+    } else if (ImGui::Button("Start trace capture")) {
+        Profiler::startCapture();
+        Profiler::setEnabled(true);
+    }
+    
+    ImGui::End();
 }
 
 void UI::renderLoginScreen() {
@@ -298,29 +563,59 @@ void UI::renderFeedScreen() {
     ImGui::SetCursorPos(ImVec2(20, 20));
     ImGui::Text("Home Feed");
     
+    // Latest / Top toggle
+    ImGui::SameLine();
+    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 170);
+    ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+    for (int mode = 0; mode < 2; mode++) {
+        bool active = feed->isRanked() == (mode == 1);
+        ImGui::PushStyleColor(ImGuiCol_Button, active ? ImVec4(0.5f, 0.3f, 0.9f, 0.6f)
+                                                      : ImVec4(0.3f, 0.3f, 0.4f, 0.5f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.6f, 0.4f, 1.0f, 0.7f));
+        if (mode == 1) ImGui::SameLine();
+        if (ImGui::Button(mode == 0 ? "Latest" : "Top", ImVec2(70, 24)) && !active) {
+            feed->setRanked(mode == 1);
+            feed->generateFeed(currentUser, postDatabase);
+        }
+        ImGui::PopStyleColor(2);
+    }
+    ImGui::PopStyleVar();
+    
     ImGui::SetCursorPos(ImVec2(20, 50));
     ImGui::BeginChild("FeedScroll", ImVec2(0, 0), false);
     
-    FeedNode* node = feed->getHead();
-    if (!node) {
+    if (feed->getCount() == 0) {
         ImGui::SetCursorPos(ImVec2(20, 100));
         ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f),
                           "No posts to show.\nFollow users to see their posts!");
     }
     
-    while (node) {
-        Post* post = node->post;
+    // At most FEED_SIZE rows with cached text heights: cheap to lay out
+    // every frame, which also covers every way the feed is regenerated
+    float wrapWidth = ImGui::GetWindowWidth() - 70;
+    feedLayout.clear(wrapWidth);
+    for (int row = 0; row < feed->getCount(); row++) {
+        Post* post = feed->getPost(row);
+        feedLayout.add(textHeight(post->content, postCache(post), wrapWidth));
+    }
+    
+    int firstRow, lastRow;
+    feedLayout.begin(firstRow, lastRow);
+    for (int row = firstRow; row < lastRow; row++) {
+        Post* post = feed->getPost(row);
+        float cardHeight = feedLayout.beginRow(row);
+        RenderCache& cache = postCache(post);
         
         ImGui::PushID(post->postID);
         
         // Post card background
         ImDrawList* drawList = ImGui::GetWindowDrawList();
         ImVec2 cardStart = ImGui::GetCursorScreenPos();
-        ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + 140);
+        ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + cardHeight);
         
         drawList->AddRectFilled(cardStart, cardEnd, IM_COL32(20, 20, 30, 255), 12.0f);
         
-        ImGui::Dummy(ImVec2(0, 10));
+        ImGui::Dummy(ImVec2(0, CARD_PADDING));
         ImGui::Indent(15);
         
         // Username button
@@ -336,21 +631,18 @@ void UI::renderFeedScreen() {
         ImGui::PopStyleColor(3);
         
         // Post content
-        ImGui::PushTextWrapPos(ImGui::GetCursorPosX() + ImGui::GetWindowWidth() - 70);
-        ImGui::Text("%s", post->content.c_str());
-        ImGui::PopTextWrapPos();
+        wrappedText(post->content, cache, wrapWidth);
         
         ImGui::Dummy(ImVec2(0, 5));
         
         // Timestamp
-        ImGui::TextColored(ImVec4(0.4f, 0.4f, 0.4f, 1.0f),
-                          "%s", timestampToString(post->timestamp).c_str());
+        ColoredLabel(ImVec4(0.4f, 0.4f, 0.4f, 1.0f), timeLabel(cache, post->timestamp));
         
         ImGui::Dummy(ImVec2(0, 5));
         
         // Stats
-        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
-                          "Likes: %d  |  Comments: %d", post->likes, post->commentCount);
+        ColoredLabel(ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
+                     statsLabel(cache, post->likes, post->commentCount));
         
         ImGui::Dummy(ImVec2(0, 8));
         
@@ -361,8 +653,8 @@ void UI::renderFeedScreen() {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.7f, 1.0f, 1.0f));
             ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
             if (ImGui::SmallButton("Like")) {
-                post->addLike();
-                notifications->addNotification(LIKE, currentUser->userID,
+                postDatabase->addLike(post);
+                notifications->addNotification(post->userID, LIKE, currentUser->userID,
                                               currentUser->username, post->postID,
                                               currentUser->username + " liked your post",
                                               getCurrentTime());
@@ -384,12 +676,11 @@ void UI::renderFeedScreen() {
         ImGui::PopStyleColor(2);
         
         ImGui::Unindent(15);
-        ImGui::Dummy(ImVec2(0, 15));
         
         ImGui::PopID();
-        
-        node = node->next;
+        feedLayout.endRow(row, CARD_PADDING);
     }
+    feedLayout.end();
     
     ImGui::Dummy(ImVec2(0, 20));
     
@@ -449,6 +740,10 @@ void UI::renderProfileScreen() {
     // Stats
     ImGui::Text("Followers: %d  |  Following: %d",
                 viewingUser->followerCount, viewingUser->followingCount);
+    if (viewingUser->userID != currentUser->userID) {
+        const char* common = commonConnectionsLabel();
+        if (common[0]) ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "%s", common);
+    }
     
     ImGui::Dummy(ImVec2(0, 20));
     
@@ -469,7 +764,7 @@ void UI::renderProfileScreen() {
             if (GradientButton("Follow", ImVec2(150, 35))) {
                 currentUser->addFollowing(viewingUser->userID);
                 viewingUser->addFollower(currentUser->userID);
-                notifications->addNotification(FOLLOW, currentUser->userID,
+                notifications->addNotification(viewingUser->userID, FOLLOW, currentUser->userID,
                                               currentUser->username, 0,
                                               currentUser->username + " followed you",
                                               getCurrentTime());
@@ -501,55 +796,67 @@ void UI::renderProfileScreen() {
     ImGui::Dummy(ImVec2(0, 10));
     ImGui::Unindent(20);
     
-    Post* post = postDatabase->getHead();
-    bool foundPosts = false;
-    
-    while (post) {
-        if (post->userID == viewingUser->userID) {
-            foundPosts = true;
-            ImGui::PushID(post->postID);
-            
-            // Post card
-            ImVec2 cardStart = ImGui::GetCursorScreenPos();
-            ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + 120);
-            drawList->AddRectFilled(cardStart, cardEnd, IM_COL32(20, 20, 30, 255), 12.0f);
-            
-            ImGui::Dummy(ImVec2(0, 10));
-            ImGui::Indent(20);
-            
-            ImGui::PushTextWrapPos(ImGui::GetCursorPosX() + ImGui::GetWindowWidth() - 80);
-            ImGui::Text("%s", post->content.c_str());
-            ImGui::PopTextWrapPos();
-            
-            ImGui::TextColored(ImVec4(0.4f, 0.4f, 0.4f, 1.0f),
-                              "%s", timestampToString(post->timestamp).c_str());
-            ImGui::Text("Likes: %d | Comments: %d", post->likes, post->commentCount);
-            
-            ImGui::Dummy(ImVec2(0, 5));
-            
-            if (ImGui::SmallButton("View")) {
-                viewingPost = post;
-                setScreen(POST_DETAIL_SCREEN);
-            }
-            
-            if (post->userID == currentUser->userID) {
-                ImGui::SameLine();
-                ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.2f, 0.2f, 0.5f));
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(1.0f, 0.3f, 0.3f, 0.7f));
-                if (ImGui::SmallButton("Delete")) {
-                    postDatabase->deletePost(post->postID);
-                    feed->generateFeed(currentUser, postDatabase);
-                }
-                ImGui::PopStyleColor(2);
+    // Rebuild the row list only when the user or the post set changed
+    float wrapWidth = ImGui::GetWindowWidth() - 80;
+    if (profilePostsUserID != viewingUser->userID ||
+        profilePostsVersion != postDatabase->getVersion() || profileLayout.needsBuild(wrapWidth)) {
+        profilePosts.clear();
+        profileLayout.clear(wrapWidth);
+        for (Post* p = postDatabase->getHead(); p; p = p->next) {
+            if (p->userID != viewingUser->userID) continue;
+            profilePosts.push_back(p);
+            profileLayout.add(textHeight(p->content, postCache(p), wrapWidth));
+        }
+        profilePostsUserID = viewingUser->userID;
+        profilePostsVersion = postDatabase->getVersion();
+    }
+    bool foundPosts = !profilePosts.empty();
+    
+    int firstRow, lastRow;
+    profileLayout.begin(firstRow, lastRow);
+    for (int row = firstRow; row < lastRow; row++) {
+        Post* post = profilePosts[row];
+        float cardHeight = profileLayout.beginRow(row);
+        RenderCache& cache = postCache(post);
+        ImGui::PushID(post->postID);
+        
+        // Post card
+        ImVec2 cardStart = ImGui::GetCursorScreenPos();
+        ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + cardHeight);
+        drawList->AddRectFilled(cardStart, cardEnd, IM_COL32(20, 20, 30, 255), 12.0f);
+        
+        ImGui::Dummy(ImVec2(0, CARD_PADDING));
+        ImGui::Indent(20);
+        
+        wrappedText(post->content, cache, wrapWidth);
+        
+        ColoredLabel(ImVec4(0.4f, 0.4f, 0.4f, 1.0f), timeLabel(cache, post->timestamp));
+        ImGui::TextUnformatted(statsLabel(cache, post->likes, post->commentCount));
+        
+        ImGui::Dummy(ImVec2(0, 5));
+        
+        if (ImGui::SmallButton("View")) {
+            viewingPost = post;
+            setScreen(POST_DETAIL_SCREEN);
+        }
+        
+        if (post->userID == currentUser->userID) {
+            ImGui::SameLine();
+            ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.2f, 0.2f, 0.5f));
+            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(1.0f, 0.3f, 0.3f, 0.7f));
+            if (ImGui::SmallButton("Delete")) {
+                postDatabase->deletePost(post->postID);
+                feed->generateFeed(currentUser, postDatabase);
             }
-            
-            ImGui::Unindent(20);
-            ImGui::Dummy(ImVec2(0, 15));
-            
-            ImGui::PopID();
+            ImGui::PopStyleColor(2);
         }
-        post = post->next;
+        
+        ImGui::Unindent(20);
+        
+        ImGui::PopID();
+        profileLayout.endRow(row, CARD_PADDING);
     }
+    profileLayout.end();
     
     if (!foundPosts) {
         ImGui::Indent(20);
@@ -569,11 +876,14 @@ void UI::renderNotificationsScreen() {
     ImGui::SetWindowFontScale(1.0f);
     
     ImGui::SameLine();
-    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100);
+    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 230);
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.3f,0.3f,0.4f,1.0f));
     ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.4f,0.4f,0.5f,1.0f));
     ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
-    if (ImGui::Button("Clear All", ImVec2(80,30))) notifications->clearAll();
+    if (ImGui::Button("Mark All Read", ImVec2(120,30))) notifications->markAllRead(currentUser->userID);
+    ImGui::SameLine();
+    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100);
+    if (ImGui::Button("Clear All", ImVec2(80,30))) notifications->clearInbox(currentUser->userID);
     ImGui::PopStyleVar();
     ImGui::PopStyleColor(2);
 
@@ -581,17 +891,12 @@ void UI::renderNotificationsScreen() {
     ImGui::SetCursorPos(ImVec2(20,70));
     ImGui::BeginChild("NotificationScroll", ImVec2(0,0), false);
 
-    Notification* notifArr[200];
     int count = 0;
-    notifications->getAllNotifications(notifArr, count);
-
-    if (count == 0) {
-        ImGui::TextColored(ImVec4(0.5f,0.5f,0.5f,1.0f), "No notifications");
-    }
+    notifications->getAllNotifications(currentUser->userID, notificationRows.data(), count,
+                                       (int)notificationRows.size());
 
     for (int i = 0; i < count; i++) {
-        Notification* n = notifArr[i];
-        if (n->fromUserID == currentUser->userID) continue;
+        Notification* n = notificationRows[i];
 
         ImGui::PushID(n->notificationID);
 
@@ -605,6 +910,7 @@ void UI::renderNotificationsScreen() {
             case COMMENT: cardColor = IM_COL32(40,25,35,255); break;
             case LIKE:    cardColor = IM_COL32(40,35,25,255); break;
             case FOLLOW:  cardColor = IM_COL32(25,35,40,255); break;
+            case MENTION: cardColor = IM_COL32(25,40,30,255); break;
         }
         drawList->AddRectFilled(start, end, cardColor, 12.0f);
 
@@ -618,20 +924,21 @@ void UI::renderNotificationsScreen() {
             case COMMENT: typeStr="COMMENT"; typeColor=ImVec4(1,0.4f,0.4f,1); break;
             case LIKE:    typeStr="LIKE";    typeColor=ImVec4(1,0.8f,0.2f,1); break;
             case FOLLOW:  typeStr="FOLLOW";  typeColor=ImVec4(0.3f,0.7f,1,1); break;
+            case MENTION: typeStr="MENTION"; typeColor=ImVec4(0.4f,0.9f,0.5f,1); break;
         }
 
         ImGui::TextColored(typeColor, "[%s]", typeStr);
         ImGui::SameLine();
         ImGui::Text("%s", n->message.c_str());
 
-        ImGui::TextColored(ImVec4(0.5f,0.5f,0.5f,1), "%s", timestampToString(n->timestamp).c_str());
+        ColoredLabel(ImVec4(0.5f,0.5f,0.5f,1), timeLabel(notificationCache(n), n->timestamp));
 
         // Mark as read button
         if (!n->isRead) {
             ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.4f,0.3f,0.8f,0.5f));
             ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.5f,0.4f,0.9f,0.7f));
             ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
-            if (ImGui::SmallButton("Mark Read")) n->isRead = true;
+            if (ImGui::SmallButton("Mark Read")) notifications->markAsRead(n);
             ImGui::PopStyleVar();
             ImGui::PopStyleColor(2);
         }
@@ -641,6 +948,19 @@ void UI::renderNotificationsScreen() {
         ImGui::PopID();
     }
 
+    if (count == 0) {
+        ImGui::TextColored(ImVec4(0.5f,0.5f,0.5f,1.0f), "No notifications");
+    }
+    
+    // Evicted and cleared notifications never come back
+    if ((int)notificationCaches.size() > 2 * count + 64) {
+        unordered_map<int, RenderCache> shown;
+        for (int i = 0; i < count; i++) {
+            shown[notificationRows[i]->notificationID] = notificationCache(notificationRows[i]);
+        }
+        notificationCaches.swap(shown);
+    }
+
     ImGui::Dummy(ImVec2(0,20));
     ImGui::EndChild();
 }
@@ -651,81 +971,321 @@ void UI::renderSearchScreen() {
     ImGui::Text("Search");
     ImGui::SetWindowFontScale(1.0f);
     
+    // Users / Posts toggle
+    ImGui::SameLine();
+    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 170);
+    ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+    for (int mode = 0; mode < 2; mode++) {
+        bool active = searchPostsMode == (mode == 1);
+        ImGui::PushStyleColor(ImGuiCol_Button, active ? ImVec4(0.5f, 0.3f, 0.9f, 0.6f)
+                                                      : ImVec4(0.3f, 0.3f, 0.4f, 0.5f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.6f, 0.4f, 1.0f, 0.7f));
+        if (mode == 1) ImGui::SameLine();
+        if (ImGui::Button(mode == 0 ? "Users" : "Posts", ImVec2(70, 28)) && !active) {
+            searchPostsMode = mode == 1;
+            searchResultCount = 0;
+            postResultCount = 0;
+            postResultsQuery.clear();
+            if (searchPostsMode) {
+                typeahead->setQuery("", true);
+            } else {
+                typeahead->setQuery(searchInput, true);
+            }
+        }
+        ImGui::PopStyleColor(2);
+    }
+    ImGui::PopStyleVar();
+    
     ImGui::SetCursorPos(ImVec2(20, 70));
     
     // Search bar
     ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 10.0f);
     ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.15f, 0.15f, 0.2f, 1.0f));
     ImGui::SetNextItemWidth(ImGui::GetWindowWidth() - 140);
-    ImGui::InputTextWithHint("##search", "Search user...", searchInput, 64);
+    const char* hint = searchPostsMode ? "Search posts... (a OR b, -word, \"phrase\", #tag, @user)" : "Search user...";
+    bool edited = ImGui::InputTextWithHint("##search", hint, searchInput, 64);
     ImGui::PopStyleColor();
     ImGui::PopStyleVar();
     
+    // Results follow the text as it is typed; the button skips the debounce
     ImGui::SameLine();
-    if (GradientButton("Search", ImVec2(90, 32))) {
-        searchResultCount = 0;
-        if (strlen(searchInput) > 0) {
-            User* allUsers[100];
-            int userCount = 0;
-            userDatabase->getAllUsers(allUsers, userCount);
-            
-            string searchTerm = searchInput;
-            transform(searchTerm.begin(), searchTerm.end(), searchTerm.begin(), ::tolower);
-            
-            for (int i = 0; i < userCount; i++) {
-                string username = allUsers[i]->username;
-                transform(username.begin(), username.end(), username.begin(), ::tolower);
-                
-                if (username.find(searchTerm) != string::npos) {
-                    searchResults[searchResultCount++] = allUsers[i];
-                }
-            }
+    bool searchNow = GradientButton("Search", ImVec2(90, 32));
+    if (edited || searchNow) {
+        if (searchPostsMode) {
+            postResultsQuery = searchInput;
+            postResultsVersion = -1;
+            if (postResultsQuery.empty()) postResultCount = 0;
+        } else {
+            typeahead->setQuery(searchInput, searchNow || searchInput[0] == '\0');
         }
     }
+    if (!searchPostsMode) {
+        typeahead->poll(typeaheadVersion, searchResults, searchResultCount);
+    }
+    
+    // Deleted posts would leave dangling results, so re-run on any change
+    // A lone "#tag" or "@name" lists that tag's or user's timeline instead
+    if (searchPostsMode && !postResultsQuery.empty() && postResultsVersion != postDatabase->getVersion()) {
+        char marker = postResultsQuery[0];
+        bool single = postResultsQuery.size() > 1 && postResultsQuery.find(' ') == string::npos;
+        if (single && marker == '#') {
+            postResultCount = postDatabase->getTagPosts(postResultsQuery.substr(1), postResults, 100);
+        } else if (single && marker == '@') {
+            postResultCount = postDatabase->getMentions(postResultsQuery.substr(1), postResults, 100);
+        } else {
+            postResultCount = postDatabase->searchPosts(postResultsQuery, postResults, 100);
+        }
+        postResultsVersion = postDatabase->getVersion();
+    }
+    
+    // With no query, show what is trending; likes move it without bumping
+    // the post version, so it is read every frame (a few microseconds)
+    bool showTrending = searchPostsMode && postResultsQuery.empty();
+    if (showTrending) {
+        trendingTagCount = postDatabase->getTrendingTags(trendingTags, nullptr, 10);
+        postResultCount = postDatabase->getTrendingPosts(postResults, nullptr, 20);
+    }
     
     ImGui::SetCursorPos(ImVec2(20, 120));
     ImGui::BeginChild("SearchResults", ImVec2(0, 0), false);
     
+    if (showTrending) {
+        if (trendingTagCount == 0 && postResultCount == 0) {
+            ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Nothing trending yet.");
+            ImGui::EndChild();
+            return;
+        }
+        
+        ImGui::TextColored(ImVec4(0.8f, 0.7f, 1.0f, 1.0f), "Trending");
+        ImGui::Dummy(ImVec2(0, 5));
+        
+        // Tag chips, wrapped to the window width
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.5f, 0.3f, 0.9f, 0.3f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.6f, 0.4f, 1.0f, 0.5f));
+        ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 10.0f);
+        float rowRight = ImGui::GetWindowPos().x + ImGui::GetWindowWidth() - 40;
+        for (int i = 0; i < trendingTagCount; i++) {
+            string label = "#" + trendingTags[i];
+            float width = ImGui::CalcTextSize(label.c_str()).x + ImGui::GetStyle().FramePadding.x * 2;
+            if (i > 0) {
+                float nextX = ImGui::GetItemRectMax().x + ImGui::GetStyle().ItemSpacing.x;
+                if (nextX + width < rowRight) ImGui::SameLine();
+            }
+            ImGui::PushID(i);
+            if (ImGui::Button(label.c_str())) {
+                snprintf(searchInput, sizeof(searchInput), "%s", label.c_str());
+                postResultsQuery = searchInput;
+                postResultsVersion = -1;
+            }
+            ImGui::PopID();
+        }
+        ImGui::PopStyleVar();
+        ImGui::PopStyleColor(2);
+        ImGui::Dummy(ImVec2(0, 10));
+    }
+    
+    if (searchPostsMode) {
+        renderPostSearchResults();
+        ImGui::EndChild();
+        return;
+    }
+    
+    if (searchInput[0] == '\0') {
+        renderSuggestions();
+        ImGui::EndChild();
+        return;
+    }
+    
     if (searchResultCount == 0) {
         ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f),
                           "No results.\nTry searching for a username.");
     }
     
-    for (int i = 0; i < searchResultCount; i++) {
-        ImGui::PushID(i);
+    ImGuiListClipper clipper;
+    clipper.Begin(searchResultCount, SEARCH_CARD_HEIGHT + CARD_GAP);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            float rowY = ImGui::GetCursorPosY();
+            ImGui::PushID(i);
+            
+            // User card
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            ImVec2 cardStart = ImGui::GetCursorScreenPos();
+            ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + SEARCH_CARD_HEIGHT);
+            drawList->AddRectFilled(cardStart, cardEnd, IM_COL32(20, 20, 30, 255), 12.0f);
+            
+            ImGui::Dummy(ImVec2(0, 10));
+            ImGui::Indent(15);
+            
+            // Username button
+            ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.3f, 0.3f, 0.4f, 0.3f));
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.6f, 0.5f, 1.0f, 1.0f));
+            ImGui::SetWindowFontScale(1.2f);
+            if (ImGui::Button(searchResults[i]->username.c_str())) {
+                viewingUser = searchResults[i];
+                setScreen(PROFILE_SCREEN);
+            }
+            ImGui::SetWindowFontScale(1.0f);
+            ImGui::PopStyleColor(3);
+            
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
+                              "Followers: %d", searchResults[i]->followerCount);
+            
+            ImGui::Unindent(15);
+            
+            ImGui::PopID();
+            EndFixedRow(rowY, SEARCH_CARD_HEIGHT + CARD_GAP);
+        }
+    }
+    clipper.End();
+    
+    ImGui::Dummy(ImVec2(0, 20));
+    ImGui::EndChild();
+}
+
+void UI::renderSuggestions() {
+    // Any follow can change the answer: the people this user follows may
+    // follow someone new too
+    int followVersion = User::followVersion.load();
+    if (suggestionsUserID != currentUser->userID || suggestionsFollowVersion != followVersion) {
+        suggestionCount = userDatabase->recommendFollows(currentUser, suggestions, suggestionConnections, 10);
+        suggestionsUserID = currentUser->userID;
+        suggestionsFollowVersion = followVersion;
+    }
+    
+    if (suggestionCount == 0) {
+        ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f),
+                          "Search for a username.\nFollow a few people to get suggestions here.");
+        return;
+    }
+    
+    ImGui::TextColored(ImVec4(0.8f, 0.7f, 1.0f, 1.0f), "Who to follow");
+    ImGui::Dummy(ImVec2(0, 5));
+    
+    for (int i = 0; i < suggestionCount; i++) {
+        User* user = suggestions[i];
+        float rowY = ImGui::GetCursorPosY();
+        ImGui::PushID(user->userID);
         
-        // User card
         ImDrawList* drawList = ImGui::GetWindowDrawList();
         ImVec2 cardStart = ImGui::GetCursorScreenPos();
-        ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + 80);
+        ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + SEARCH_CARD_HEIGHT);
         drawList->AddRectFilled(cardStart, cardEnd, IM_COL32(20, 20, 30, 255), 12.0f);
         
         ImGui::Dummy(ImVec2(0, 10));
         ImGui::Indent(15);
         
-        // Username button
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.3f, 0.3f, 0.4f, 0.3f));
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.6f, 0.5f, 1.0f, 1.0f));
         ImGui::SetWindowFontScale(1.2f);
-        if (ImGui::Button(searchResults[i]->username.c_str())) {
-            viewingUser = searchResults[i];
+        if (ImGui::Button(user->username.c_str())) {
+            viewingUser = user;
             setScreen(PROFILE_SCREEN);
         }
         ImGui::SetWindowFontScale(1.0f);
         ImGui::PopStyleColor(3);
         
-        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
-                          "Followers: %d", searchResults[i]->followerCount);
+        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Followed by %d %s you follow",
+                          suggestionConnections[i], suggestionConnections[i] == 1 ? "person" : "people");
+        
+        ImGui::Unindent(15);
+        ImGui::PopID();
+        EndFixedRow(rowY, SEARCH_CARD_HEIGHT + CARD_GAP);
+    }
+    
+    ImGui::Dummy(ImVec2(0, 20));
+}
+
+// "Followed by a, b and 3 others you follow  |  5 mutual followers" for the
+// profile being viewed. Intersecting large follower lists takes a
+// millisecond or two, so the text is only rebuilt after a follow changes.
+const char* UI::commonConnectionsLabel() {
+    int key[3] = { viewingUser->userID, currentUser->userID, User::followVersion.load() };
+    if (memcmp(key, connectionsKey, sizeof(key)) == 0) return connectionsLabel.c_str();
+    memcpy(connectionsKey, key, sizeof(key));
+    
+    int names[2];
+    int followedBy = viewingUser->getFollowedByFollowing(currentUser, names, 2);
+    int mutual = viewingUser->getMutualFollowers(currentUser, nullptr, 0);
+    
+    connectionsLabel.clear();
+    if (followedBy > 0) {
+        connectionsLabel = "Followed by ";
+        int shown = min(followedBy, 2);
+        for (int i = 0; i < shown; i++) {
+            User* user = userDatabase->searchByID(names[i]);
+            if (i > 0) connectionsLabel += followedBy == 2 ? " and " : ", ";
+            connectionsLabel += user ? user->username : "?";
+        }
+        if (followedBy > 2) {
+            connectionsLabel += " and " + to_string(followedBy - 2) + (followedBy == 3 ? " other" : " others");
+        }
+        connectionsLabel += " you follow";
+    }
+    if (mutual > 0) {
+        if (!connectionsLabel.empty()) connectionsLabel += "  |  ";
+        connectionsLabel += to_string(mutual) + (mutual == 1 ? " mutual follower" : " mutual followers");
+    }
+    return connectionsLabel.c_str();
+}
+
+void UI::renderPostSearchResults() {
+    if (postResultCount == 0 && !postResultsQuery.empty()) {
+        ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f),
+                          "No results.\nTry searching for words in a post or its comments.");
+    }
+    
+    // At most 100 rows with cached text heights, laid out every frame
+    float wrapWidth = ImGui::GetWindowWidth() - 70;
+    postResultsLayout.clear(wrapWidth);
+    for (int i = 0; i < postResultCount; i++) {
+        postResultsLayout.add(textHeight(postResults[i]->content, postCache(postResults[i]), wrapWidth));
+    }
+    
+    int firstRow, lastRow;
+    postResultsLayout.begin(firstRow, lastRow);
+    for (int i = firstRow; i < lastRow; i++) {
+        Post* post = postResults[i];
+        float cardHeight = postResultsLayout.beginRow(i);
+        RenderCache& cache = postCache(post);
+        ImGui::PushID(post->postID);
+        
+        // Post card
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 cardStart = ImGui::GetCursorScreenPos();
+        ImVec2 cardEnd = ImVec2(cardStart.x + ImGui::GetWindowWidth() - 40, cardStart.y + cardHeight);
+        drawList->AddRectFilled(cardStart, cardEnd, IM_COL32(20, 20, 30, 255), 12.0f);
+        
+        ImGui::Dummy(ImVec2(0, CARD_PADDING));
+        ImGui::Indent(15);
+        
+        ImGui::TextColored(ImVec4(0.6f, 0.5f, 1.0f, 1.0f), "%s", post->username.c_str());
+        wrappedText(post->content, cache, wrapWidth);
+        
+        ImGui::Dummy(ImVec2(0, 5));
+        ColoredLabel(ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
+                     statsLabel(cache, post->likes, post->commentCount));
+        ImGui::SameLine();
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.3f, 0.3f, 0.4f, 0.5f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.4f, 0.4f, 0.5f, 0.7f));
+        ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+        if (ImGui::SmallButton("Open")) {
+            viewingPost = post;
+            setScreen(POST_DETAIL_SCREEN);
+        }
+        ImGui::PopStyleVar();
+        ImGui::PopStyleColor(2);
         
         ImGui::Unindent(15);
-        ImGui::Dummy(ImVec2(0, 15));
         
         ImGui::PopID();
+        postResultsLayout.endRow(i, CARD_PADDING);
     }
+    postResultsLayout.end();
     
     ImGui::Dummy(ImVec2(0, 20));
-    ImGui::EndChild();
 }
 
 void UI::renderCreatePostScreen() {
@@ -785,8 +1345,9 @@ void UI::renderCreatePostScreen() {
         } else if (len > 280) {
             showErrorMessage("Post is too long (max 280 characters)");
         } else {
-            postDatabase->createPost(currentUser->userID, currentUser->username,
-                                    postInput, getCurrentTime());
+            Post* post = postDatabase->createPost(currentUser->userID, currentUser->username,
+                                                  postInput, getCurrentTime());
+            if (post) postDatabase->notifyMentions(post, userDatabase, notifications);
             feed->generateFeed(currentUser, postDatabase);
             memset(postInput, 0, sizeof(postInput));
             setScreen(FEED_SCREEN);
@@ -838,25 +1399,23 @@ void UI::renderPostDetailScreen() {
     ImGui::Dummy(ImVec2(0, 10));
     
     // Post content
-    ImGui::PushTextWrapPos(ImGui::GetCursorPosX() + ImGui::GetWindowWidth() - 70);
-    ImGui::Text("%s", viewingPost->content.c_str());
-    ImGui::PopTextWrapPos();
+    RenderCache& postLabels = postCache(viewingPost);
+    wrappedText(viewingPost->content, postLabels, ImGui::GetWindowWidth() - 70);
     
     ImGui::Dummy(ImVec2(0, 10));
     
-    ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f),
-                      "%s", timestampToString(viewingPost->timestamp).c_str());
+    ColoredLabel(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), timeLabel(postLabels, viewingPost->timestamp));
     
-    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
-                      "Likes: %d  |  Comments: %d", viewingPost->likes, viewingPost->commentCount);
+    ColoredLabel(ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
+                 statsLabel(postLabels, viewingPost->likes, viewingPost->commentCount));
     
     ImGui::Dummy(ImVec2(0, 15));
     
     // Like button
     if (viewingPost->userID != currentUser->userID) {
         if (GradientButton("Like", ImVec2(100, 35))) {
-            viewingPost->addLike();
-            notifications->addNotification(LIKE, currentUser->userID,
+            postDatabase->addLike(viewingPost);
+            notifications->addNotification(viewingPost->userID, LIKE, currentUser->userID,
                                           currentUser->username, viewingPost->postID,
                                           currentUser->username + " liked your post",
                                           getCurrentTime());
@@ -874,40 +1433,54 @@ void UI::renderPostDetailScreen() {
     ImGui::Unindent(15);
     ImGui::Dummy(ImVec2(0, 10));
     
-    // Comments list
-    Comment* comment = viewingPost->getComments();
-    if (!comment) {
+    // Comments list (rebuilt only when the post or its comment count changes)
+    float wrapWidth = ImGui::GetWindowWidth() - 70;
+    if (commentRowsPostID != viewingPost->postID || commentRowsCount != viewingPost->commentCount ||
+        commentLayout.needsBuild(wrapWidth)) {
+        commentRows.clear();
+        commentLayout.clear(wrapWidth);
+        for (Comment* c = viewingPost->getComments(); c; c = c->next) {
+            commentRows.push_back(c);
+            commentLayout.add(textHeight(c->content, commentCache(viewingPost, c), wrapWidth));
+        }
+        commentRowsPostID = viewingPost->postID;
+        commentRowsCount = viewingPost->commentCount;
+    }
+    
+    if (commentRows.empty()) {
         ImGui::Indent(15);
         ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "No comments yet");
         ImGui::Unindent(15);
     }
     
-    while (comment) {
+    int firstRow, lastRow;
+    commentLayout.begin(firstRow, lastRow);
+    for (int row = firstRow; row < lastRow; row++) {
+        Comment* comment = commentRows[row];
+        float cardHeight = commentLayout.beginRow(row);
+        RenderCache& cache = commentCache(viewingPost, comment);
         ImGui::PushID(comment->commentID);
         
         // Comment card
         ImVec2 commentStart = ImGui::GetCursorScreenPos();
-        ImVec2 commentEnd = ImVec2(commentStart.x + ImGui::GetWindowWidth() - 40, commentStart.y + 90);
+        ImVec2 commentEnd = ImVec2(commentStart.x + ImGui::GetWindowWidth() - 40, commentStart.y + cardHeight);
         drawList->AddRectFilled(commentStart, commentEnd, IM_COL32(25, 25, 35, 255), 10.0f);
         
-        ImGui::Dummy(ImVec2(0, 10));
+        ImGui::Dummy(ImVec2(0, CARD_PADDING));
         ImGui::Indent(15);
         
         ImGui::TextColored(ImVec4(0.4f, 0.6f, 1.0f, 1.0f), "%s:", comment->username.c_str());
         
-        ImGui::PushTextWrapPos(ImGui::GetCursorPosX() + ImGui::GetWindowWidth() - 70);
-        ImGui::Text("%s", comment->content.c_str());
-        ImGui::PopTextWrapPos();
+        wrappedText(comment->content, cache, wrapWidth);
         
-        ImGui::TextColored(ImVec4(0.4f, 0.4f, 0.4f, 1.0f),
-                          "%s", timestampToString(comment->timestamp).c_str());
+        ColoredLabel(ImVec4(0.4f, 0.4f, 0.4f, 1.0f), timeLabel(cache, comment->timestamp));
         
         ImGui::Unindent(15);
-        ImGui::Dummy(ImVec2(0, 15));
         
         ImGui::PopID();
-        comment = comment->next;
+        commentLayout.endRow(row, CARD_PADDING);
     }
+    commentLayout.end();
     
     // Add comment section
     if (viewingPost->userID != currentUser->userID) {
@@ -925,9 +1498,9 @@ void UI::renderPostDetailScreen() {
         
         if (GradientButton("Post Comment", ImVec2(150, 35))) {
             if (strlen(commentInput) > 0) {
-                viewingPost->addComment(currentUser->userID, currentUser->username,
-                                       commentInput, getCurrentTime());
-                notifications->addNotification(COMMENT, currentUser->userID,
+                postDatabase->addComment(viewingPost, currentUser->userID, currentUser->username,
+                                         commentInput, getCurrentTime());
+                notifications->addNotification(viewingPost->userID, COMMENT, currentUser->userID,
                                               currentUser->username, viewingPost->postID,
                                               currentUser->username + " commented on your post",
                                               getCurrentTime());
@@ -967,21 +1540,21 @@ void UI::initializeDummyData() {
     };
     
     if (bob) {
-        notifications->addNotification(LIKE, bob->userID, bob->username, 1005,
+        notifications->addNotification(alice->userID, LIKE, bob->userID, bob->username, 1005,
             "bob liked your post", minutesAgo(30));
-        notifications->addNotification(COMMENT, bob->userID, bob->username, 1005,
+        notifications->addNotification(alice->userID, COMMENT, bob->userID, bob->username, 1005,
             "bob commented on your post", minutesAgo(25));
     }
     
     if (charlie) {
-        notifications->addNotification(FOLLOW, charlie->userID, charlie->username, 0,
+        notifications->addNotification(alice->userID, FOLLOW, charlie->userID, charlie->username, 0,
             "charlie followed you", minutesAgo(45));
-        notifications->addNotification(COMMENT, charlie->userID, charlie->username, 1010,
+        notifications->addNotification(alice->userID, COMMENT, charlie->userID, charlie->username, 1010,
             "charlie commented on your post", minutesAgo(20));
     }
     
     if (eve) {
-        notifications->addNotification(LIKE, eve->userID, eve->username, 1010,
+        notifications->addNotification(alice->userID, LIKE, eve->userID, eve->username, 1010,
             "eve liked your post", minutesAgo(60));
     }
 }
\ No newline at end of file
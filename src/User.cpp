@@ -1,9 +1,12 @@
-#include "../include/App.h"
+#include "../include/Core.h"
 
 // ==================== USER CLASS ====================
+atomic<int> User::followVersion(0);
+
 User::User(int id, const string& uname, const string& pass, const string& userBio)
     : userID(id), username(uname), password(pass), bio(userBio),
-      followingCount(0), followerCount(0), followingCapacity(10), followersCapacity(10) {
+      followingCount(0), followerCount(0), followingCapacity(10), followersCapacity(10),
+      influence(0.0f), componentID(id) {
     followingList = new int[followingCapacity];
     followersList = new int[followersCapacity];
 }
@@ -13,88 +16,90 @@ User::~User() {
     delete[] followersList;
 }
 
-bool User::addFollowing(int targetID) {
-    // Check if already following
-    for (int i = 0; i < followingCount; i++) {
-        if (followingList[i] == targetID) return false;
-    }
+// Follow lists are kept sorted by ID: membership is a binary search and
+// common connections are a merge of two lists (see intersectSorted)
+static bool insertSortedID(int*& list, int& count, int& capacity, int id) {
+    int pos = (int)(lower_bound(list, list + count, id) - list);
+    if (pos < count && list[pos] == id) return false;
     
     // Resize if needed
-    if (followingCount >= followingCapacity) {
-        followingCapacity *= 2;
-        int* newList = new int[followingCapacity];
-        for (int i = 0; i < followingCount; i++) {
-            newList[i] = followingList[i];
-        }
-        delete[] followingList;
-        followingList = newList;
+    if (count >= capacity) {
+        capacity *= 2;
+        int* newList = new int[capacity];
+        memcpy(newList, list, count * sizeof(int));
+        delete[] list;
+        list = newList;
     }
     
-    followingList[followingCount++] = targetID;
+    memmove(list + pos + 1, list + pos, (count - pos) * sizeof(int));
+    list[pos] = id;
+    count++;
+    return true;
+}
+
+static bool removeSortedID(int* list, int& count, int id) {
+    int pos = (int)(lower_bound(list, list + count, id) - list);
+    if (pos == count || list[pos] != id) return false;
+    memmove(list + pos, list + pos + 1, (count - pos - 1) * sizeof(int));
+    count--;
+    return true;
+}
+
+bool User::addFollowing(int targetID) {
+    if (!insertSortedID(followingList, followingCount, followingCapacity, targetID)) return false;
+    followVersion++;
+    Metrics::followChanges.add();
+    ChangeSignal::raise();
     return true;
 }
 
 bool User::removeFollowing(int targetID) {
-    for (int i = 0; i < followingCount; i++) {
-        if (followingList[i] == targetID) {
-            // Shift elements
-            for (int j = i; j < followingCount - 1; j++) {
-                followingList[j] = followingList[j + 1];
-            }
-            followingCount--;
-            return true;
-        }
-    }
-    return false;
+    if (!removeSortedID(followingList, followingCount, targetID)) return false;
+    followVersion++;
+    Metrics::followChanges.add();
+    ChangeSignal::raise();
+    return true;
 }
 
 bool User::addFollower(int followerID) {
-    // Check if already a follower
-    for (int i = 0; i < followerCount; i++) {
-        if (followersList[i] == followerID) return false;
-    }
-    
-    // Resize if needed
-    if (followerCount >= followersCapacity) {
-        followersCapacity *= 2;
-        int* newList = new int[followersCapacity];
-        for (int i = 0; i < followerCount; i++) {
-            newList[i] = followersList[i];
-        }
-        delete[] followersList;
-        followersList = newList;
-    }
-    
-    followersList[followerCount++] = followerID;
+    if (!insertSortedID(followersList, followerCount, followersCapacity, followerID)) return false;
+    followVersion++;
+    ChangeSignal::raise();
     return true;
 }
 
 bool User::removeFollower(int followerID) {
-    for (int i = 0; i < followerCount; i++) {
-        if (followersList[i] == followerID) {
-            // Shift elements
-            for (int j = i; j < followerCount - 1; j++) {
-                followersList[j] = followersList[j + 1];
-            }
-            followerCount--;
-            return true;
-        }
-    }
-    return false;
+    if (!removeSortedID(followersList, followerCount, followerID)) return false;
+    followVersion++;
+    ChangeSignal::raise();
+    return true;
 }
 
 bool User::isFollowing(int targetID) const {
-    for (int i = 0; i < followingCount; i++) {
-        if (followingList[i] == targetID) return true;
-    }
-    return false;
+    return binary_search(followingList, followingList + followingCount, targetID);
+}
+
+bool User::isFollowedBy(int userID) const {
+    return binary_search(followersList, followersList + followerCount, userID);
+}
+
+int User::getFollowedByFollowing(const User* viewer, int* ids, int maxIDs) const {
+    return intersectSorted(followersList, followerCount, viewer->followingList, viewer->followingCount, ids, maxIDs);
+}
+
+int User::getMutualFollowers(const User* other, int* ids, int maxIDs) const {
+    return intersectSorted(followersList, followerCount, other->followersList, other->followerCount, ids, maxIDs);
 }
 
 // ==================== USER DATABASE CLASS ====================
-UserDatabase::UserDatabase() : root(nullptr), nextUserID(1001) {}
+UserDatabase::UserDatabase() : root(nullptr), nextUserID(1001), userCount(0), nameTableSize(64) {
+    nameTable = new User*[nameTableSize]();
+}
 
 UserDatabase::~UserDatabase() {
     destroyTree(root);
+    delete[] nameTable;
+    Metrics::users.add(-userCount);
 }
 
 void UserDatabase::destroyTree(UserNode* node) {
@@ -105,6 +110,43 @@ void UserDatabase::destroyTree(UserNode* node) {
     delete node;
 }
 
+UserNode* UserDatabase::rotateLeft(UserNode* node) {
+    UserNode* pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    node->height = 1 + max(height(node->left), height(node->right));
+    pivot->height = 1 + max(height(pivot->left), height(pivot->right));
+    return pivot;
+}
+
+UserNode* UserDatabase::rotateRight(UserNode* node) {
+    UserNode* pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    node->height = 1 + max(height(node->left), height(node->right));
+    pivot->height = 1 + max(height(pivot->left), height(pivot->right));
+    return pivot;
+}
+
+UserNode* UserDatabase::rebalance(UserNode* node) {
+    node->height = 1 + max(height(node->left), height(node->right));
+    int balance = height(node->left) - height(node->right);
+    
+    if (balance > 1) {
+        if (height(node->left->left) < height(node->left->right)) {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+    if (balance < -1) {
+        if (height(node->right->right) < height(node->right->left)) {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
 UserNode* UserDatabase::insertNode(UserNode* node, User* user) {
     if (!node) return new UserNode(user);
     
@@ -112,31 +154,56 @@ UserNode* UserDatabase::insertNode(UserNode* node, User* user) {
         node->left = insertNode(node->left, user);
     } else if (user->userID > node->user->userID) {
         node->right = insertNode(node->right, user);
+    } else {
+        return node;
     }
     
-    return node;
+    return rebalance(node);
 }
 
 UserNode* UserDatabase::searchByID(UserNode* node, int userID) {
-    if (!node || node->user->userID == userID) return node;
-    
-    if (userID < node->user->userID) {
-        return searchByID(node->left, userID);
+    while (node && node->user->userID != userID) {
+        node = userID < node->user->userID ? node->left : node->right;
     }
-    return searchByID(node->right, userID);
+    return node;
 }
 
-User* UserDatabase::searchByUsername(UserNode* node, const string& username) {
-    if (!node) return nullptr;
-    
-    if (node->user->username == username) {
-        return node->user;
+// ==================== USERNAME TABLE ====================
+User* UserDatabase::findName(const string& username) {
+    int mask = nameTableSize - 1;
+    int i = (int)(fnv1a(username) & (uint32_t)mask);
+    while (nameTable[i]) {
+        if (nameTable[i]->username == username) return nameTable[i];
+        i = (i + 1) & mask;
+    }
+    return nullptr;
+}
+
+// Users are never removed, so the table only grows. The first user with a
+// name keeps it.
+void UserDatabase::addName(User* user) {
+    if ((userCount + 1) * 2 > nameTableSize) {
+        User** oldTable = nameTable;
+        int oldSize = nameTableSize;
+        nameTableSize *= 2;
+        nameTable = new User*[nameTableSize]();
+        int mask = nameTableSize - 1;
+        for (int b = 0; b < oldSize; b++) {
+            if (!oldTable[b]) continue;
+            int i = (int)(fnv1a(oldTable[b]->username) & (uint32_t)mask);
+            while (nameTable[i]) i = (i + 1) & mask;
+            nameTable[i] = oldTable[b];
+        }
+        delete[] oldTable;
     }
     
-    User* leftResult = searchByUsername(node->left, username);
-    if (leftResult) return leftResult;
-    
-    return searchByUsername(node->right, username);
+    int mask = nameTableSize - 1;
+    int i = (int)(fnv1a(user->username) & (uint32_t)mask);
+    while (nameTable[i]) {
+        if (nameTable[i]->username == user->username) return;
+        i = (i + 1) & mask;
+    }
+    nameTable[i] = user;
 }
 
 void UserDatabase::collectUsers(UserNode* node, User** arr, int& index) {
@@ -147,10 +214,15 @@ void UserDatabase::collectUsers(UserNode* node, User** arr, int& index) {
 }
 
 User* UserDatabase::registerUser(const string& username, const string& password, const string& bio) {
-    // Validate username
+    MetricTimer timer(Metrics::registerLatency);
+    
+    // Validate username: one line in users.txt, one token in an @mention
     if (username.length() < 3 || username.length() > 20) {
         return nullptr;
     }
+    for (unsigned char c : username) {
+        if (c <= ' ' || c == 0x7f) return nullptr;
+    }
     
     // Validate password
     if (password.length() < 6) {
@@ -158,35 +230,45 @@ User* UserDatabase::registerUser(const string& username, const string& password,
     }
     
     // Check if username exists
-    if (searchByUsername(root, username)) {
+    if (findName(username)) {
         return nullptr;
     }
     
     // Create new user
     User* newUser = new User(nextUserID++, username, password, bio);
     root = insertNode(root, newUser);
+    addName(newUser);
+    userCount++;
+    searchIndex.add(newUser);
+    Metrics::usersRegistered.add();
+    Metrics::users.add(1);
     
+    ChangeSignal::raise();
     return newUser;
 }
 
 User* UserDatabase::login(const string& username, const string& password) {
-    User* user = searchByUsername(root, username);
-    if (!user) return nullptr;
+    MetricTimer timer(Metrics::loginLatency);
     
-    if (user->password == password) {
+    User* user = findName(username);
+    if (user && user->password == password) {
+        Metrics::logins.add();
         return user;
     }
     
+    Metrics::loginFailures.add();
     return nullptr;
 }
 
 User* UserDatabase::searchByID(int userID) {
+    Metrics::userLookups.add();
     UserNode* node = searchByID(root, userID);
     return node ? node->user : nullptr;
 }
 
 User* UserDatabase::searchByUsername(const string& username) {
-    return searchByUsername(root, username);
+    Metrics::userLookups.add();
+    return findName(username);
 }
 
 void UserDatabase::getAllUsers(User** arr, int& count) {
@@ -194,6 +276,56 @@ void UserDatabase::getAllUsers(User** arr, int& count) {
     collectUsers(root, arr, count);
 }
 
+int UserDatabase::searchUsers(const string& query, User** results, int maxResults, bool prefixOnly) {
+    MetricTimer timer(Metrics::userSearchLatency);
+    Metrics::userSearches.add();
+    // The candidate window covers modest drift in follower counts; past
+    // that, renumber so posting order matches the ranking again
+    int drift = User::followVersion.load() - searchIndex.getRankedFollowVersion();
+    if (drift > max((int)RERANK_MIN_CHANGES, userCount / 10)) {
+        searchIndex.rerank();
+    }
+    return searchIndex.search(query, prefixOnly, results, maxResults);
+}
+
+int UserDatabase::recommendFollows(User* user, User** results, int* connections, int maxResults) {
+    MetricTimer timer(Metrics::recommendLatency);
+    return recommender.recommend(this, user, results, connections, maxResults);
+}
+
+// ==================== GRAPH ANALYTICS ====================
+bool UserDatabase::runGraphAnalytics(int threads, GraphAnalyticsReport* report) {
+    ScopedTimer timer("UserDatabase::runGraphAnalytics");
+    GraphAnalytics analytics;
+    if (!analytics.snapshot(this, threads)) return false;
+    analytics.compute();
+    publishGraphAnalytics(&analytics, report);
+    return true;
+}
+
+void UserDatabase::publishGraphAnalytics(GraphAnalytics* analytics, GraphAnalyticsReport* report) {
+    Metrics::graphAnalyticsLatency.record((uint64_t)(analytics->elapsedSeconds() * 1e9));
+    analytics->publish(report);
+
+    // The recommender ranks by slot, so hand it influence indexed the same way
+    int slots = nextUserID - FollowRecommender::FIRST_USER_ID;
+    if (slots > 0) {
+        float* scores = new float[slots]();
+        User** all = new User*[userCount];
+        int count = 0;
+        getAllUsers(all, count);
+        for (int i = 0; i < count; i++) {
+            int slot = all[i]->userID - FollowRecommender::FIRST_USER_ID;
+            if ((unsigned)slot < (unsigned)slots) scores[slot] = all[i]->influence;
+        }
+        recommender.setInfluence(scores, slots);
+        delete[] all;
+        delete[] scores;
+    }
+
+    searchIndex.rerank();
+}
+
 // ==================== DUMMY DATA GENERATION ====================
 void UserDatabase::generateDummyUsers() {
     // Create 5 dummy users
@@ -249,17 +381,33 @@ void UserDatabase::generateDummyUsers() {
     
     eve->addFollowing(diana->userID);
     diana->addFollower(eve->userID);
+    
+    searchIndex.rerank();
 }
 
 // ==================== FILE HANDLING ====================
+static void appendID(int*& list, int& count, int& capacity, int id) {
+    if (count >= capacity) {
+        capacity *= 2;
+        int* newList = new int[capacity];
+        for (int i = 0; i < count; i++) {
+            newList[i] = list[i];
+        }
+        delete[] list;
+        list = newList;
+    }
+    list[count++] = id;
+}
+
 void UserDatabase::saveToFile(const string& filename) {
+    MetricTimer timer(Metrics::saveLatency);
     ofstream file(filename);
     if (!file.is_open()) {
         cerr << "Error: Could not open " << filename << " for writing" << endl;
         return;
     }
     
-    User* users[100];
+    User** users = new User*[userCount];
     int count = 0;
     getAllUsers(users, count);
     
@@ -275,11 +423,13 @@ void UserDatabase::saveToFile(const string& filename) {
         file << u->followingCount << endl;
     }
     
+    delete[] users;
     file.close();
     cout << "Saved " << count << " users to " << filename << endl;
 }
 
 void UserDatabase::loadFromFile(const string& filename) {
+    MetricTimer timer(Metrics::loadLatency);
     ifstream file(filename);
     if (!file.is_open()) {
         cout << "No existing users file found. Starting fresh." << endl;
@@ -303,9 +453,15 @@ void UserDatabase::loadFromFile(const string& filename) {
         file >> followerCount >> followingCount;
         file.ignore();
         
+        if (searchByID(root, userID)) continue; // Already loaded
+        
         // Create user directly with ID
         User* newUser = new User(userID, username, password, bio);
         root = insertNode(root, newUser);
+        addName(newUser);
+        userCount++;
+        searchIndex.add(newUser);
+        Metrics::users.add(1);
         
         // Update nextUserID
         if (userID >= nextUserID) {
@@ -314,17 +470,19 @@ void UserDatabase::loadFromFile(const string& filename) {
     }
     
     file.close();
+    ChangeSignal::raise();
     cout << "Loaded " << count << " users from " << filename << endl;
 }
 
 void UserDatabase::saveConnectionsToFile(const string& filename) {
+    MetricTimer timer(Metrics::saveLatency);
     ofstream file(filename);
     if (!file.is_open()) {
         cerr << "Error: Could not open " << filename << " for writing" << endl;
         return;
     }
     
-    User* users[100];
+    User** users = new User*[userCount];
     int count = 0;
     getAllUsers(users, count);
     
@@ -336,28 +494,63 @@ void UserDatabase::saveConnectionsToFile(const string& filename) {
         }
     }
     
+    delete[] users;
     file.close();
     cout << "Saved connections to " << filename << endl;
 }
 
 void UserDatabase::loadConnectionsFromFile(const string& filename) {
+    MetricTimer timer(Metrics::loadLatency);
     ifstream file(filename);
     if (!file.is_open()) {
         cout << "No existing connections file found." << endl;
         return;
     }
     
+    // Resolve IDs by binary search over a flat, ID-ordered copy of the tree;
+    // far fewer cache misses than walking the tree twice per edge
+    User** users = new User*[userCount];
+    int count = 0;
+    getAllUsers(users, count);
+    int* ids = new int[count];
+    for (int i = 0; i < count; i++) {
+        ids[i] = users[i]->userID;
+    }
+    bool dense = count > 0 && ids[count - 1] - ids[0] + 1 == count; // No gaps: index directly
+    auto lookup = [&](int id) -> User* {
+        if (dense) return (id >= ids[0] && id <= ids[count - 1]) ? users[id - ids[0]] : nullptr;
+        int* it = lower_bound(ids, ids + count, id);
+        return (it != ids + count && *it == id) ? users[it - ids] : nullptr;
+    };
+    
+    // Append without the per-edge duplicate scan (quadratic for users with
+    // many followers), then sort and de-duplicate every list once at the end
     int userID, followingID;
+    User* user = nullptr;
     while (file >> userID >> followingID) {
-        User* user = searchByID(userID);
-        User* target = searchByID(followingID);
+        if (!user || user->userID != userID) user = lookup(userID); // Grouped by follower
+        User* target = lookup(followingID);
         
-        if (user && target) {
-            user->addFollowing(followingID);
-            target->addFollower(userID);
+        if (user && target && user != target) {
+            appendID(user->followingList, user->followingCount, user->followingCapacity, followingID);
+            appendID(target->followersList, target->followerCount, target->followersCapacity, userID);
         }
     }
-    
     file.close();
+    
+    for (int i = 0; i < count; i++) {
+        User* u = users[i];
+        sort(u->followingList, u->followingList + u->followingCount);
+        u->followingCount = (int)(unique(u->followingList, u->followingList + u->followingCount) - u->followingList);
+        sort(u->followersList, u->followersList + u->followerCount);
+        u->followerCount = (int)(unique(u->followersList, u->followersList + u->followerCount) - u->followersList);
+    }
+    delete[] ids;
+    delete[] users;
+    
+    // Follower counts are final now; search ranks by them
+    searchIndex.rerank();
+    
+    ChangeSignal::raise();
     cout << "Loaded connections from " << filename << endl;
 }
\ No newline at end of file
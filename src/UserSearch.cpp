@@ -0,0 +1,319 @@
+#include "../include/Core.h"
+
+// ==================== USER SEARCH INDEX ====================
+static inline char lowerChar(char c) {
+    return (char)tolower((unsigned char)c);
+}
+
+static inline uint32_t trigramKey(const char* p) {
+    return ((uint32_t)(unsigned char)p[0] << 16) | ((uint32_t)(unsigned char)p[1] << 8) |
+           (uint32_t)(unsigned char)p[2];
+}
+
+// Trigram keys use 24 bits; bigrams share the table with a tag above them
+static const uint32_t BIGRAM_TAG = 1u << 24;
+
+static inline uint32_t bigramKey(unsigned char first, unsigned char second) {
+    return BIGRAM_TAG | ((uint32_t)first << 8) | second;
+}
+
+UserSearchIndex::UserSearchIndex()
+    : table(nullptr), docs(nullptr), nameStart(nullptr), names(nullptr),
+      candidates(nullptr), candidateCapacity(0), rankedFollowVersion(0) {
+    clear();
+}
+
+UserSearchIndex::~UserSearchIndex() {
+    for (int i = 0; i < tableSize; i++) {
+        delete[] table[i].docs;
+    }
+    delete[] table;
+    delete[] docs;
+    delete[] nameStart;
+    delete[] names;
+    delete[] candidates;
+}
+
+void UserSearchIndex::clear() {
+    if (table) {
+        for (int i = 0; i < tableSize; i++) {
+            delete[] table[i].docs;
+        }
+    }
+    delete[] table;
+    delete[] docs;
+    delete[] nameStart;
+    delete[] names;
+
+    tableSize = 1024;
+    tableUsed = 0;
+    table = new PostingList[tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i].key = EMPTY_KEY;
+        table[i].docs = nullptr;
+        table[i].count = 0;
+        table[i].capacity = 0;
+    }
+
+    docCount = 0;
+    docCapacity = 64;
+    docs = new User*[docCapacity];
+    nameStart = new int[docCapacity + 1];
+    nameStart[0] = 0;
+    namesSize = 0;
+    namesCapacity = 1024;
+    names = new char[namesCapacity];
+}
+
+UserSearchIndex::PostingList* UserSearchIndex::findList(uint32_t key, bool create) {
+    uint32_t hash = key * 0x9E3779B1u;
+    int mask = tableSize - 1;
+    int index = (int)((hash ^ (hash >> 16)) & (uint32_t)mask);
+    while (table[index].key != EMPTY_KEY) {
+        if (table[index].key == key) return &table[index];
+        index = (index + 1) & mask;
+    }
+    if (!create) return nullptr;
+
+    // Keep the table at most half full
+    if ((tableUsed + 1) * 2 > tableSize) {
+        growTable();
+        return findList(key, true);
+    }
+    PostingList& list = table[index];
+    list.key = key;
+    list.capacity = 4;
+    list.docs = new int[list.capacity];
+    list.count = 0;
+    tableUsed++;
+    return &list;
+}
+
+void UserSearchIndex::growTable() {
+    PostingList* oldTable = table;
+    int oldSize = tableSize;
+
+    tableSize *= 2;
+    table = new PostingList[tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i].key = EMPTY_KEY;
+        table[i].docs = nullptr;
+        table[i].count = 0;
+        table[i].capacity = 0;
+    }
+
+    int mask = tableSize - 1;
+    for (int i = 0; i < oldSize; i++) {
+        if (oldTable[i].key == EMPTY_KEY) continue;
+        uint32_t hash = oldTable[i].key * 0x9E3779B1u;
+        int index = (int)((hash ^ (hash >> 16)) & (uint32_t)mask);
+        while (table[index].key != EMPTY_KEY) {
+            index = (index + 1) & mask;
+        }
+        table[index] = oldTable[i]; // Moves the posting array
+    }
+    delete[] oldTable;
+}
+
+void UserSearchIndex::appendDoc(User* user) {
+    if (docCount == docCapacity) {
+        int newCapacity = docCapacity * 2;
+        User** newDocs = new User*[newCapacity];
+        int* newStart = new int[newCapacity + 1];
+        memcpy(newDocs, docs, docCount * sizeof(User*));
+        memcpy(newStart, nameStart, (docCount + 1) * sizeof(int));
+        delete[] docs;
+        delete[] nameStart;
+        docs = newDocs;
+        nameStart = newStart;
+        docCapacity = newCapacity;
+    }
+
+    int length = (int)user->username.size();
+    if (namesSize + length + 1 > namesCapacity) {
+        int newCapacity = namesCapacity * 2;
+        while (newCapacity < namesSize + length + 1) newCapacity *= 2;
+        char* newNames = new char[newCapacity];
+        memcpy(newNames, names, namesSize);
+        delete[] names;
+        names = newNames;
+        namesCapacity = newCapacity;
+    }
+
+    char* out = names + namesSize;
+    for (int i = 0; i < length; i++) {
+        out[i] = lowerChar(user->username[i]);
+    }
+    out[length] = '\0';
+    namesSize += length + 1;
+
+    docs[docCount] = user;
+    nameStart[docCount + 1] = namesSize;
+    docCount++;
+}
+
+void UserSearchIndex::indexDoc(int doc) {
+    const char* name = names + nameStart[doc];
+    int length = nameStart[doc + 1] - nameStart[doc] - 1;
+
+    // "^^name" so prefixes have their own trigrams
+    string padded(2, START_MARKER);
+    padded.append(name, length);
+
+    for (int i = 0; i + 3 <= length + 2; i++) {
+        addPosting(trigramKey(padded.data() + i), doc);
+    }
+    // Bigrams (including marker + first letter) answer one and two
+    // character queries
+    for (int i = 1; i + 2 <= length + 2; i++) {
+        addPosting(bigramKey((unsigned char)padded[i], (unsigned char)padded[i + 1]), doc);
+    }
+}
+
+void UserSearchIndex::addPosting(uint32_t key, int doc) {
+    PostingList* list = findList(key, true);
+    if (list->count > 0 && list->docs[list->count - 1] == doc) return; // Repeated in this name
+    if (list->count == list->capacity) {
+        list->capacity *= 2;
+        int* newDocs = new int[list->capacity];
+        memcpy(newDocs, list->docs, list->count * sizeof(int));
+        delete[] list->docs;
+        list->docs = newDocs;
+    }
+    list->docs[list->count++] = doc;
+}
+
+bool UserSearchIndex::matches(int doc, const string& query, bool prefixOnly) {
+    const char* name = names + nameStart[doc];
+    if (prefixOnly) return strncmp(name, query.c_str(), query.size()) == 0;
+    int length = nameStart[doc + 1] - nameStart[doc] - 1;
+    return findCaseless(name, length, query.data(), (int)query.size()) >= 0;
+}
+
+void UserSearchIndex::add(User* user) {
+    appendDoc(user);
+    indexDoc(docCount - 1);
+}
+
+void UserSearchIndex::rerank() {
+    rankedFollowVersion = User::followVersion.load();
+    int count = docCount;
+    User** ranked = new User*[count];
+    memcpy(ranked, docs, count * sizeof(User*));
+    stable_sort(ranked, ranked + count, [](const User* a, const User* b) {
+        if (rankedAbove(a, b)) return true;
+        if (rankedAbove(b, a)) return false;
+        return a->userID < b->userID;
+    });
+
+    // Renumber in place, keeping the posting arrays' memory
+    for (int i = 0; i < tableSize; i++) {
+        table[i].count = 0;
+    }
+    docCount = 0;
+    namesSize = 0;
+    for (int i = 0; i < count; i++) {
+        add(ranked[i]);
+    }
+    delete[] ranked;
+}
+
+int UserSearchIndex::search(const string& query, bool prefixOnly, User** results, int maxResults) {
+    if (query.empty() || maxResults <= 0 || docCount == 0) return 0;
+
+    string lower = query;
+    for (char& c : lower) c = lowerChar(c);
+    string pattern = prefixOnly ? string(2, START_MARKER) + lower : lower;
+    int found = 0;
+
+    int limit = (int)min((long long)maxResults * CANDIDATE_FACTOR, (long long)docCount);
+    if (limit > candidateCapacity) {
+        delete[] candidates;
+        candidateCapacity = max(limit, candidateCapacity * 2);
+        candidates = new User*[candidateCapacity];
+    }
+
+    if (pattern.size() == 2) {
+        // Exactly the names holding this bigram
+        PostingList* list = findList(bigramKey((unsigned char)pattern[0], (unsigned char)pattern[1]), false);
+        for (int i = 0; list && i < list->count && found < limit; i++) {
+            candidates[found++] = docs[list->docs[i]];
+        }
+    } else if (pattern.size() == 1) {
+        // A letter is the second half of some bigram ending in it; merge
+        // those lists in document order until enough distinct names are out
+        unsigned char c = (unsigned char)pattern[0];
+        PostingList* lists[256];
+        int cursor[256];
+        int listCount = 0;
+        for (int first = 0; first < 256; first++) {
+            PostingList* list = findList(bigramKey((unsigned char)first, c), false);
+            if (list && list->count > 0) {
+                cursor[listCount] = 0;
+                lists[listCount++] = list;
+            }
+        }
+        int last = -1;
+        while (found < limit) {
+            int best = -1;
+            for (int j = 0; j < listCount; j++) {
+                if (cursor[j] < lists[j]->count &&
+                    (best < 0 || lists[j]->docs[cursor[j]] < lists[best]->docs[cursor[best]])) {
+                    best = j;
+                }
+            }
+            if (best < 0) break;
+            int doc = lists[best]->docs[cursor[best]++];
+            if (doc != last) candidates[found++] = docs[doc];
+            last = doc;
+        }
+    } else {
+        // Intersect the query's trigram lists, driven by the shortest one.
+        // Trigrams beyond the first MAX_LISTS are left to the final check.
+        const int MAX_LISTS = 32;
+        PostingList* lists[MAX_LISTS];
+        int cursor[MAX_LISTS];
+        int listCount = 0;
+        for (size_t i = 0; i + 3 <= pattern.size() && listCount < MAX_LISTS; i++) {
+            PostingList* list = findList(trigramKey(pattern.data() + i), false);
+            if (!list || list->count == 0) return 0;
+            bool seen = false;
+            for (int j = 0; j < listCount; j++) seen = seen || lists[j] == list;
+            if (!seen) lists[listCount++] = list;
+        }
+        sort(lists, lists + listCount, [](const PostingList* a, const PostingList* b) {
+            return a->count < b->count;
+        });
+        for (int j = 0; j < listCount; j++) cursor[j] = 0;
+
+        PostingList* driver = lists[0];
+        for (int i = 0; i < driver->count && found < limit; i++) {
+            int doc = driver->docs[i];
+            bool inAll = true;
+            for (int j = 1; j < listCount; j++) {
+                cursor[j] = gallopSearch(lists[j]->docs, lists[j]->count, cursor[j], doc);
+                if (cursor[j] == lists[j]->count) {
+                    i = driver->count; // This list is exhausted; nothing later can match
+                    inAll = false;
+                    break;
+                }
+                if (lists[j]->docs[cursor[j]] != doc) {
+                    inAll = false;
+                    break;
+                }
+            }
+            // Trigrams can match out of order ("abcab" vs "cabc"); confirm
+            if (inAll && matches(doc, lower, prefixOnly)) candidates[found++] = docs[doc];
+        }
+    }
+
+    // Follows since the last rerank can reorder the candidates themselves
+    int kept = min(found, maxResults);
+    partial_sort(candidates, candidates + kept, candidates + found, [](const User* a, const User* b) {
+        if (rankedAbove(a, b)) return true;
+        if (rankedAbove(b, a)) return false;
+        return a->userID < b->userID;
+    });
+    memcpy(results, candidates, kept * sizeof(User*));
+    return kept;
+}